@@ -0,0 +1,311 @@
+/******************************************************************************
+ *
+ * Module: Common - Formatted output
+ *
+ * File Name: FORMAT.c
+ *
+ * Description: Source file for the lightweight printf subset
+ *
+ * Creator: Hossam Mohamed
+ *
+ *******************************************************************************/
+#include "FORMAT.h"
+
+/* Format flags */
+#define FORMAT_FLAG_LEFT 		0x01 /* '-' : pad on the right */
+#define FORMAT_FLAG_ZERO 		0x02 /* '0' : pad with zeros after the sign */
+#define FORMAT_FLAG_LONG 		0x04 /* 'l' : 32-bit argument */
+#define FORMAT_FLAG_UPPER 		0x08 /* 'X' : upper case hexadecimal */
+
+/* longest converted number: 10 decimal digits (the zeros of %q are not stored) */
+#define FORMAT_DIGITS_SIZE 		10
+
+/*
+ * Powers of ten for the subtraction based conversion,
+ * a digit needs at most 9 subtractions instead of a 32-bit division and modulo.
+ */
+static const uint32 FORMAT_Pow10_32[] = {1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL, 10000UL};
+static const uint16 FORMAT_Pow10_16[] = {10000U, 1000U, 100U, 10U};
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+static void FORMAT_Repeat(FORMAT_SinkType a_sink, uint8 a_char, sint16 a_count)
+{
+	while (a_count > 0)
+	{
+		a_sink(a_char);
+		a_count--;
+	}
+}
+
+/*
+ * Output a converted number: [padding][sign][zeros][digits with the decimal point]
+ * a_precision > 0 inserts the decimal point before the last a_precision digits.
+ * Also used for %c and %s, which are padded the same way.
+ */
+static uint16 FORMAT_PutNumber(FORMAT_SinkType a_sink, const char *a_digits, uint8 a_length, uint8 a_negative,
+							   uint8 a_flags, uint8 a_width, uint8 a_precision)
+{
+	uint8 i;
+	uint8 leadingZeros = 0;
+	uint8 bodyLength;
+	sint16 padding;
+
+	if (a_precision != 0 && a_length <= a_precision)
+	{
+		leadingZeros = a_precision + 1 - a_length; // "0.00ddd"
+	}
+
+	bodyLength = a_negative + leadingZeros + a_length + (a_precision != 0 ? 1 : 0);
+	padding = (sint16)a_width - bodyLength;
+
+	if (!(a_flags & (FORMAT_FLAG_LEFT | FORMAT_FLAG_ZERO)))
+	{
+		FORMAT_Repeat(a_sink, ' ', padding);
+	}
+	if (a_negative)
+	{
+		a_sink('-');
+	}
+	if ((a_flags & (FORMAT_FLAG_LEFT | FORMAT_FLAG_ZERO)) == FORMAT_FLAG_ZERO)
+	{
+		FORMAT_Repeat(a_sink, '0', padding);
+	}
+
+	for (i = 0; i < leadingZeros + a_length; i++)
+	{
+		if (a_precision != 0 && i == leadingZeros + a_length - a_precision)
+		{
+			a_sink('.');
+		}
+		a_sink((i < leadingZeros) ? '0' : a_digits[i - leadingZeros]);
+	}
+
+	if (a_flags & FORMAT_FLAG_LEFT)
+	{
+		FORMAT_Repeat(a_sink, ' ', padding);
+	}
+
+	return bodyLength + (padding > 0 ? padding : 0);
+}
+
+static uint8 FORMAT_UnsignedToHex(uint32 a_value, char *a_buffer, uint8 a_flags)
+{
+	const char *hexLookup = (a_flags & FORMAT_FLAG_UPPER) ? "0123456789ABCDEF" : "0123456789abcdef";
+	char reversed[8];
+	uint8 length = 0;
+	uint8 i;
+
+	do
+	{
+		reversed[length++] = hexLookup[(uint8)a_value & 0x0F];
+		a_value >>= 4;
+	} while (a_value != 0);
+
+	for (i = 0; i < length; i++)
+	{
+		a_buffer[i] = reversed[length - 1 - i];
+	}
+	return length;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+uint8 FORMAT_UnsignedToDecimal(uint32 a_value, char *a_buffer)
+{
+	uint8 i = 0;
+	uint8 length = 0;
+	uint16 value16;
+	char digit;
+
+	/* upper digits in 32-bit arithmetic, only for values above 65535 */
+	if (a_value > 0xFFFFUL)
+	{
+		for (i = 0; i < sizeof(FORMAT_Pow10_32) / sizeof(FORMAT_Pow10_32[0]); i++)
+		{
+			digit = '0';
+			while (a_value >= FORMAT_Pow10_32[i])
+			{
+				a_value -= FORMAT_Pow10_32[i];
+				digit++;
+			}
+			if (digit != '0' || length != 0)
+			{
+				a_buffer[length++] = digit;
+			}
+		}
+		i = 1; // the 10000s digit is already done
+	}
+
+	/* the rest is below 65536 (below 10000 after the 32-bit part) */
+	value16 = (uint16)a_value;
+	for (; i < sizeof(FORMAT_Pow10_16) / sizeof(FORMAT_Pow10_16[0]); i++)
+	{
+		digit = '0';
+		while (value16 >= FORMAT_Pow10_16[i])
+		{
+			value16 -= FORMAT_Pow10_16[i];
+			digit++;
+		}
+		if (digit != '0' || length != 0)
+		{
+			a_buffer[length++] = digit;
+		}
+	}
+	a_buffer[length++] = '0' + (uint8)value16; // units digit, also prints "0"
+
+	return length;
+}
+
+uint16 FORMAT_vprintf(FORMAT_SinkType a_sink, const char *a_format, va_list a_args)
+{
+	char digits[FORMAT_DIGITS_SIZE];
+	uint16 count = 0;
+	uint8 flags;
+	uint8 width;
+	uint8 precision;
+	uint8 length;
+	uint8 negative;
+	sint32 signedValue;
+	uint32 value;
+	const char *str;
+
+	while (*a_format != '\0')
+	{
+		if (*a_format != '%')
+		{
+			a_sink(*a_format++);
+			count++;
+			continue;
+		}
+		a_format++;
+
+		/********************************* flags *********************************/
+		flags = 0;
+		while (*a_format == '-' || *a_format == '0')
+		{
+			flags |= (*a_format == '-') ? FORMAT_FLAG_LEFT : FORMAT_FLAG_ZERO;
+			a_format++;
+		}
+
+		/********************************* width *********************************/
+		width = 0;
+		if (*a_format == '*')
+		{
+			width = (uint8)va_arg(a_args, int);
+			a_format++;
+		}
+		while (*a_format >= '0' && *a_format <= '9')
+		{
+			width = width * 10 + (*a_format++ - '0');
+		}
+
+		/******************************* precision *******************************/
+		precision = 0;
+		if (*a_format == '.')
+		{
+			a_format++;
+			if (*a_format == '*')
+			{
+				precision = (uint8)va_arg(a_args, int);
+				a_format++;
+			}
+			while (*a_format >= '0' && *a_format <= '9')
+			{
+				precision = precision * 10 + (*a_format++ - '0');
+			}
+		}
+
+		/********************************* length ********************************/
+		if (*a_format == 'l')
+		{
+			flags |= FORMAT_FLAG_LONG;
+			a_format++;
+		}
+
+		/******************************* conversion ******************************/
+		negative = FALSE;
+		switch (*a_format)
+		{
+		case 'd':
+		case 'i':
+		case 'q':
+			signedValue = (flags & FORMAT_FLAG_LONG) ? va_arg(a_args, sint32) : (sint32)va_arg(a_args, int);
+			if (signedValue < 0)
+			{
+				negative = TRUE;
+				value = (uint32)0 - (uint32)signedValue; // also correct for the most negative value
+			}
+			else
+			{
+				value = (uint32)signedValue;
+			}
+			if (*a_format != 'q')
+			{
+				precision = 0; // the decimal point is only for the fixed point conversion
+			}
+			else if (precision > FORMAT_MAX_PRECISION)
+			{
+				precision = FORMAT_MAX_PRECISION;
+			}
+			length = FORMAT_UnsignedToDecimal(value, digits);
+			count += FORMAT_PutNumber(a_sink, digits, length, negative, flags, width, precision);
+			break;
+
+		case 'u':
+			value = (flags & FORMAT_FLAG_LONG) ? va_arg(a_args, uint32) : (uint32)va_arg(a_args, unsigned int);
+			length = FORMAT_UnsignedToDecimal(value, digits);
+			count += FORMAT_PutNumber(a_sink, digits, length, FALSE, flags, width, 0);
+			break;
+
+		case 'X':
+			flags |= FORMAT_FLAG_UPPER;
+			/* fall through */
+		case 'x':
+			value = (flags & FORMAT_FLAG_LONG) ? va_arg(a_args, uint32) : (uint32)va_arg(a_args, unsigned int);
+			length = FORMAT_UnsignedToHex(value, digits, flags);
+			count += FORMAT_PutNumber(a_sink, digits, length, FALSE, flags, width, 0);
+			break;
+
+		case 'c':
+			digits[0] = (char)va_arg(a_args, int);
+			count += FORMAT_PutNumber(a_sink, digits, 1, FALSE, flags & FORMAT_FLAG_LEFT, width, 0);
+			break;
+
+		case 's':
+			str = va_arg(a_args, const char *);
+			/* the length is a uint8: a longer string is cut at 255 characters */
+			for (length = 0; str[length] != '\0' && length < 0xFF && (precision == 0 || length < precision); length++)
+				;
+			count += FORMAT_PutNumber(a_sink, str, length, FALSE, flags & FORMAT_FLAG_LEFT, width, 0);
+			break;
+
+		case '%':
+			a_sink('%');
+			count++;
+			break;
+
+		case '\0':
+			return count; // format string ended after '%'
+
+		default:
+			break; // unsupported conversion, nothing is printed
+		}
+		a_format++;
+	}
+	return count;
+}
+
+uint16 FORMAT_printf(FORMAT_SinkType a_sink, const char *a_format, ...)
+{
+	uint16 count;
+	va_list args;
+
+	va_start(args, a_format);
+	count = FORMAT_vprintf(a_sink, a_format, args);
+	va_end(args);
+
+	return count;
+}
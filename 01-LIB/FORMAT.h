@@ -0,0 +1,72 @@
+/******************************************************************************
+ *
+ * Module: Common - Formatted output
+ *
+ * File Name: FORMAT.h
+ *
+ * Description: Lightweight printf subset writing through a character sink (LCD, UART, ...)
+ * 				without avr-libc stdio or floating point.
+ *
+ * Supported conversions: %[-][0][width][.precision][l]type
+ * 		%d %i  : signed decimal (int, %ld long)
+ * 		%u     : unsigned decimal (unsigned int, %lu unsigned long)
+ * 		%x %X  : hexadecimal, lower/upper case (%lx %lX for 32-bit)
+ * 		%q     : fixed point, the integer argument is printed with 'precision' digits after
+ * 				 the decimal point (%.2q of 1234 -> "12.34", %.3lq of -5L -> "-0.005")
+ * 		%c     : character
+ * 		%s     : string ('precision' = maximum number of characters, 255 at most)
+ * 		%%     : '%'
+ * 		width and precision may be '*' to take them from the arguments (int).
+ *
+ * Creator: Hossam Mohamed
+ *
+ *******************************************************************************/
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include "STD_TYPES.h"
+#include <stdarg.h>
+
+/*******************************************************************************
+ *                      Static configurations                                  *
+ *******************************************************************************/
+/* maximum number of digits after the decimal point of %q */
+#define FORMAT_MAX_PRECISION 9
+
+/*******************************************************************************
+ *                      User defined data types                                *
+ *******************************************************************************/
+/* Output one character (LCD_displayCharacter, UART_SendByte, ...) */
+typedef void (*FORMAT_SinkType)(uint8 a_char);
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : Format the arguments according to a_format and write the result to a_sink.
+ * arguments   : FORMAT_SinkType a_sink : function called for every output character
+ * 				 const char *a_format : format string (see the supported conversions above)
+ * 				 va_list a_args : the arguments of the conversions
+ * Return      : uint16 : number of characters written to the sink
+ */
+uint16 FORMAT_vprintf(FORMAT_SinkType a_sink, const char *a_format, va_list a_args);
+
+/*
+ * Description : Format the arguments according to a_format and write the result to a_sink.
+ * arguments   : FORMAT_SinkType a_sink : function called for every output character
+ * 				 const char *a_format : format string followed by the arguments of the conversions
+ * Return      : uint16 : number of characters written to the sink
+ */
+uint16 FORMAT_printf(FORMAT_SinkType a_sink, const char *a_format, ...);
+
+/*
+ * Description : Convert an unsigned value to decimal digits by subtracting powers of ten
+ * 				 (no division, 16-bit arithmetic for values up to 65535).
+ * arguments   : uint32 a_value : value to be converted
+ * 				 char *a_buffer : at least 10 characters, the digits are not null terminated
+ * Return      : uint8 : number of digits
+ */
+uint8 FORMAT_UnsignedToDecimal(uint32 a_value, char *a_buffer);
+
+#endif /* FORMAT_H_ */
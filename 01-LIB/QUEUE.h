@@ -0,0 +1,104 @@
+/***********************************************************************************************
+ * File name: QUEUE.h
+ *
+ * Creator: Hossam Mohamed
+ *
+ * Description: Generic lock-free single-producer/single-consumer (SPSC) FIFO queue
+ *
+ * Usage:
+ *		QUEUE_DEFINE(UART_RxQueue, uint8, 32)	 // at file scope in the .c file
+ *
+ *		UART_RxQueue_Push(data);				 // producer (ISR or main loop)
+ *		UART_RxQueue_Pop(&data);				 // consumer (the other one)
+ *
+ * The macro generates a static queue and its static inline functions:
+ *		uint8 name_Push(type a_data)		  : TRUE, FALSE if the queue is full
+ *		uint8 name_Pop(type *ptr_data)		  : TRUE, FALSE if the queue is empty
+ *		volatile type *name_Peek(void)		  : oldest element in place, NULL_PTR if the queue is empty
+ *		void name_Drop(void)				  : remove the element returned by name_Peek
+ *		uint8 name_Count(void)				  : number of queued elements
+ *		uint8 name_Free(void)				  : number of free places
+ *		void name_Clear(void)				  : drop all the queued elements (consumer side)
+ *
+ * Head and tail are free running 8-bit indices (head - tail = number of queued elements) and the
+ * buffer is indexed with (index & (size - 1)), so size must be a power of two not greater than 128.
+ * Head is written only by the producer and tail only by the consumer, an 8-bit access is atomic
+ * on AVR and the element is stored before the head is moved, so one side can be an ISR and
+ * neither side has to disable interrupts.
+ * Only one producer and one consumer are allowed, two writers on the same side need a lock.
+ *
+ ************************************************************************************************/
+
+#ifndef QUEUE_H_ /*header guard*/
+#define QUEUE_H_
+
+#include "STD_TYPES.h"
+
+/* Compiler barrier: the element must be in memory before the index that publishes it */
+#define QUEUE_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+#define QUEUE_DEFINE(name, type, size)                                                                  \
+	typedef char name##_SizeCheck[(((size) & ((size) - 1)) == 0 && (size) <= 128) ? 1 : -1];              \
+                                                                                                        \
+	static volatile type name##_Buffer[size];                                                           \
+	static volatile uint8 name##_Head = 0; /* written by the producer only */                           \
+	static volatile uint8 name##_Tail = 0; /* written by the consumer only */                           \
+                                                                                                        \
+	static inline uint8 name##_Count(void)                                                              \
+	{                                                                                                   \
+		return (uint8)(name##_Head - name##_Tail);                                                      \
+	}                                                                                                   \
+                                                                                                        \
+	static inline uint8 name##_Free(void)                                                               \
+	{                                                                                                   \
+		return (uint8)((size) - (uint8)(name##_Head - name##_Tail));                                    \
+	}                                                                                                   \
+                                                                                                        \
+	static inline uint8 name##_Push(type a_data)                                                        \
+	{                                                                                                   \
+		uint8 head = name##_Head;                                                                       \
+		if ((uint8)(head - name##_Tail) >= (size))                                                      \
+		{                                                                                               \
+			return FALSE;                                                                               \
+		}                                                                                               \
+		name##_Buffer[head & ((size) - 1)] = a_data;                                                    \
+		QUEUE_BARRIER();                                                                                \
+		name##_Head = (uint8)(head + 1); /* publish the element to the consumer */                      \
+		return TRUE;                                                                                    \
+	}                                                                                                   \
+                                                                                                        \
+	static inline uint8 name##_Pop(type *ptr_data)                                                      \
+	{                                                                                                   \
+		uint8 tail = name##_Tail;                                                                       \
+		if (name##_Head == tail)                                                                        \
+		{                                                                                               \
+			return FALSE;                                                                               \
+		}                                                                                               \
+		*ptr_data = name##_Buffer[tail & ((size) - 1)];                                                 \
+		QUEUE_BARRIER();                                                                                \
+		name##_Tail = (uint8)(tail + 1); /* give the place back to the producer */                      \
+		return TRUE;                                                                                    \
+	}                                                                                                   \
+                                                                                                        \
+	static inline volatile type *name##_Peek(void)                                                      \
+	{                                                                                                   \
+		uint8 tail = name##_Tail;                                                                       \
+		if (name##_Head == tail)                                                                        \
+		{                                                                                               \
+			return NULL_PTR;                                                                            \
+		}                                                                                               \
+		return &name##_Buffer[tail & ((size) - 1)];                                                     \
+	}                                                                                                   \
+                                                                                                        \
+	static inline void name##_Drop(void)                                                                \
+	{                                                                                                   \
+		QUEUE_BARRIER();                                                                                \
+		name##_Tail = (uint8)(name##_Tail + 1);                                                         \
+	}                                                                                                   \
+                                                                                                        \
+	static inline void name##_Clear(void)                                                               \
+	{                                                                                                   \
+		name##_Tail = name##_Head;                                                                      \
+	}
+
+#endif /* QUEUE_H_ */
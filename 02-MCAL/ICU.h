@@ -13,7 +13,7 @@
 #define ICU_H_
 
 #include "STD_TYPES.h"
-#include "timer.h"
+#include "TIMER.h"
 /*******************************************************************************
  *                         Types Declaration                                   *
  *******************************************************************************/
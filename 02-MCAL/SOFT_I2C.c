@@ -0,0 +1,322 @@
+/******************************************************************************
+ *
+ * Module: Software I2C
+ *
+ * File Name: SOFT_I2C.c
+ *
+ * Description: Source file for the bit-banged I2C master on GPIO pins
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+#include "SOFT_I2C.h"
+
+#include "BIT_MACROS.h"
+#include "SOFT_I2C_config.h"
+
+#include <avr/io.h>
+#include <util/delay.h>
+
+/*************************** Pin registers ***************************************/
+/* the registers are resolved at compile time, a bit is then one sbi/cbi/sbic instruction */
+#if (SOFT_I2C_SCL_PORT_ID == PORTA_ID)
+	#define SOFT_I2C_SCL_DDR 	DDRA
+	#define SOFT_I2C_SCL_PORT 	PORTA
+	#define SOFT_I2C_SCL_PIN 	PINA
+#elif (SOFT_I2C_SCL_PORT_ID == PORTB_ID)
+	#define SOFT_I2C_SCL_DDR 	DDRB
+	#define SOFT_I2C_SCL_PORT 	PORTB
+	#define SOFT_I2C_SCL_PIN 	PINB
+#elif (SOFT_I2C_SCL_PORT_ID == PORTC_ID)
+	#define SOFT_I2C_SCL_DDR 	DDRC
+	#define SOFT_I2C_SCL_PORT 	PORTC
+	#define SOFT_I2C_SCL_PIN 	PINC
+#elif (SOFT_I2C_SCL_PORT_ID == PORTD_ID)
+	#define SOFT_I2C_SCL_DDR 	DDRD
+	#define SOFT_I2C_SCL_PORT 	PORTD
+	#define SOFT_I2C_SCL_PIN 	PIND
+#else
+	#error "SOFT_I2C_SCL_PORT_ID must be PORTA_ID .. PORTD_ID"
+#endif
+
+#if (SOFT_I2C_SDA_PORT_ID == PORTA_ID)
+	#define SOFT_I2C_SDA_DDR 	DDRA
+	#define SOFT_I2C_SDA_PORT 	PORTA
+	#define SOFT_I2C_SDA_PIN 	PINA
+#elif (SOFT_I2C_SDA_PORT_ID == PORTB_ID)
+	#define SOFT_I2C_SDA_DDR 	DDRB
+	#define SOFT_I2C_SDA_PORT 	PORTB
+	#define SOFT_I2C_SDA_PIN 	PINB
+#elif (SOFT_I2C_SDA_PORT_ID == PORTC_ID)
+	#define SOFT_I2C_SDA_DDR 	DDRC
+	#define SOFT_I2C_SDA_PORT 	PORTC
+	#define SOFT_I2C_SDA_PIN 	PINC
+#elif (SOFT_I2C_SDA_PORT_ID == PORTD_ID)
+	#define SOFT_I2C_SDA_DDR 	DDRD
+	#define SOFT_I2C_SDA_PORT 	PORTD
+	#define SOFT_I2C_SDA_PIN 	PIND
+#else
+	#error "SOFT_I2C_SDA_PORT_ID must be PORTA_ID .. PORTD_ID"
+#endif
+
+/* open drain: low = output (PORT bit 0), high = input released to the pull up */
+#define SOFT_I2C_SCL_LOW() 		SET_BIT(SOFT_I2C_SCL_DDR, SOFT_I2C_SCL_PIN_ID)
+#define SOFT_I2C_SCL_HIGH() 	CLEAR_BIT(SOFT_I2C_SCL_DDR, SOFT_I2C_SCL_PIN_ID)
+#define SOFT_I2C_SDA_LOW() 		SET_BIT(SOFT_I2C_SDA_DDR, SOFT_I2C_SDA_PIN_ID)
+#define SOFT_I2C_SDA_HIGH() 	CLEAR_BIT(SOFT_I2C_SDA_DDR, SOFT_I2C_SDA_PIN_ID)
+#define SOFT_I2C_SCL_READ() 	IS_BIT_SET(SOFT_I2C_SCL_PIN, SOFT_I2C_SCL_PIN_ID)
+#define SOFT_I2C_SDA_READ() 	IS_BIT_SET(SOFT_I2C_SDA_PIN, SOFT_I2C_SDA_PIN_ID)
+
+/*************************** Compile-time bit timing ***************************************/
+#define SOFT_I2C_HALF_PERIOD_CYCLES ((F_CPU) / (2UL * SOFT_I2C_SCL_FREQUENCY))
+
+#if (SOFT_I2C_HALF_PERIOD_CYCLES > SOFT_I2C_HALF_BIT_CYCLES)
+	#define SOFT_I2C_DELAY() \
+		_delay_us((double)(SOFT_I2C_HALF_PERIOD_CYCLES - SOFT_I2C_HALF_BIT_CYCLES) * 1000000.0 / (F_CPU))
+#else
+	#define SOFT_I2C_DELAY() // the CPU is the limit, no delay
+#endif
+
+/* the stretching loop (PIN read, test, counter decrement, branch) takes about 6 cycles */
+#define SOFT_I2C_STRETCH_LOOPS ((F_CPU) / 1000000UL * SOFT_I2C_STRETCH_TIMEOUT_US / 6UL)
+
+#if (SOFT_I2C_STRETCH_LOOPS > 65535UL) || (SOFT_I2C_STRETCH_LOOPS == 0)
+#error "SOFT_I2C_STRETCH_TIMEOUT_US doesn't fit the 16-bit wait counter at this F_CPU"
+#endif
+
+/*************************** Bus state ***************************************/
+static uint8 SOFT_I2C_status = TWI_BUS_ERROR;
+static boolean SOFT_I2C_busOwned = FALSE;	  // START sent, no STOP yet (the next START is repeated)
+static boolean SOFT_I2C_addressPhase = FALSE; // the next byte is the slave address
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+/* release SCL and wait while a slave stretches it, FALSE on timeout */
+static boolean SOFT_I2C_releaseScl(void)
+{
+	uint16 loops = (uint16)SOFT_I2C_STRETCH_LOOPS;
+
+	SOFT_I2C_SCL_HIGH();
+	while (!SOFT_I2C_SCL_READ())
+	{
+		if (--loops == 0)
+		{
+			SOFT_I2C_status = TWI_TIMEOUT;
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/* one bit driven by the master, FALSE on timeout or lost arbitration (SCL is left released) */
+static boolean SOFT_I2C_writeBit(uint8 a_bit)
+{
+	if (a_bit)
+	{
+		SOFT_I2C_SDA_HIGH();
+	}
+	else
+	{
+		SOFT_I2C_SDA_LOW();
+	}
+	SOFT_I2C_DELAY();
+
+	if (SOFT_I2C_releaseScl() == FALSE)
+	{
+		return FALSE;
+	}
+	if (a_bit && !SOFT_I2C_SDA_READ())
+	{
+		SOFT_I2C_status = TWI_ARB_LOST; // another master drives a 0, the bus is its own now
+		SOFT_I2C_busOwned = FALSE;
+		return FALSE;
+	}
+	SOFT_I2C_DELAY();
+	SOFT_I2C_SCL_LOW();
+	return TRUE;
+}
+
+/* one bit driven by the slave, 0xFF on timeout */
+static uint8 SOFT_I2C_readBit(void)
+{
+	uint8 bit;
+
+	SOFT_I2C_SDA_HIGH();
+	SOFT_I2C_DELAY();
+
+	if (SOFT_I2C_releaseScl() == FALSE)
+	{
+		return 0xFF;
+	}
+	bit = SOFT_I2C_SDA_READ() ? 1 : 0;
+	SOFT_I2C_DELAY();
+	SOFT_I2C_SCL_LOW();
+	return bit;
+}
+
+static uint8 SOFT_I2C_readByte(uint8 a_ack)
+{
+	uint8 data = 0;
+	uint8 bit;
+	uint8 i;
+
+	for (i = 0; i < 8; i++)
+	{
+		bit = SOFT_I2C_readBit();
+		if (bit == 0xFF)
+		{
+			return 0xFF;
+		}
+		data = (uint8)(data << 1) | bit;
+	}
+
+	/* ACK = SDA low, the NACK of the last byte tells the slave to release SDA */
+	if (SOFT_I2C_writeBit(a_ack ? 0 : 1) == TRUE)
+	{
+		SOFT_I2C_status = a_ack ? TWI_MR_DATA_ACK : TWI_MR_DATA_NACK;
+	}
+	return data;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+void SOFT_I2C_init(void)
+{
+	/* PORT bits stay 0: an output is low, an input has no pull up */
+	CLEAR_BIT(SOFT_I2C_SCL_PORT, SOFT_I2C_SCL_PIN_ID);
+	CLEAR_BIT(SOFT_I2C_SDA_PORT, SOFT_I2C_SDA_PIN_ID);
+	SOFT_I2C_SCL_HIGH();
+	SOFT_I2C_SDA_HIGH();
+
+	SOFT_I2C_busOwned = FALSE;
+	SOFT_I2C_addressPhase = FALSE;
+	SOFT_I2C_status = TWI_BUS_ERROR;
+}
+
+void SOFT_I2C_start(void)
+{
+	uint8 status = TWI_START;
+
+	if (SOFT_I2C_busOwned == TRUE)
+	{
+		/* repeated START: SDA high then SCL high before the START condition */
+		SOFT_I2C_SDA_HIGH();
+		SOFT_I2C_DELAY();
+		if (SOFT_I2C_releaseScl() == FALSE)
+		{
+			return;
+		}
+		SOFT_I2C_DELAY();
+		status = TWI_REP_START;
+	}
+	else if (!SOFT_I2C_SCL_READ() || !SOFT_I2C_SDA_READ())
+	{
+		SOFT_I2C_status = TWI_ARB_LOST; // the bus is used by another master or held by a slave
+		return;
+	}
+
+	/* START: SDA falls while SCL is high */
+	SOFT_I2C_SDA_LOW();
+	SOFT_I2C_DELAY();
+	SOFT_I2C_SCL_LOW();
+
+	SOFT_I2C_busOwned = TRUE;
+	SOFT_I2C_addressPhase = TRUE;
+	SOFT_I2C_status = status;
+}
+
+void SOFT_I2C_stop(void)
+{
+	/* STOP: SDA rises while SCL is high */
+	SOFT_I2C_SDA_LOW();
+	SOFT_I2C_DELAY();
+	if (SOFT_I2C_releaseScl() == TRUE)
+	{
+		SOFT_I2C_DELAY();
+	}
+	SOFT_I2C_SDA_HIGH();
+	SOFT_I2C_DELAY(); // bus free time before the next START
+
+	SOFT_I2C_busOwned = FALSE;
+}
+
+void SOFT_I2C_writeByte(uint8 data)
+{
+	uint8 read = data & 0x01; // R/W bit of an address byte
+	uint8 ack;
+	uint8 i;
+
+	for (i = 0; i < 8; i++)
+	{
+		if (SOFT_I2C_writeBit(data & 0x80) == FALSE)
+		{
+			return;
+		}
+		data <<= 1;
+	}
+
+	ack = SOFT_I2C_readBit(); // 0 = ACK
+	if (ack == 0xFF)
+	{
+		return;
+	}
+
+	/* the TWSR status of the same step */
+	if (SOFT_I2C_addressPhase == TRUE)
+	{
+		SOFT_I2C_addressPhase = FALSE;
+		if (read)
+		{
+			SOFT_I2C_status = (ack == 0) ? TWI_MT_SLA_R_ACK : TWI_MR_SLA_R_NACK;
+		}
+		else
+		{
+			SOFT_I2C_status = (ack == 0) ? TWI_MT_SLA_W_ACK : TWI_MT_SLA_W_NACK;
+		}
+	}
+	else
+	{
+		SOFT_I2C_status = (ack == 0) ? TWI_MT_DATA_ACK : TWI_MT_DATA_NACK;
+	}
+}
+
+uint8 SOFT_I2C_readByteWithACK(void)
+{
+	return SOFT_I2C_readByte(TRUE);
+}
+
+uint8 SOFT_I2C_readByteWithNACK(void)
+{
+	return SOFT_I2C_readByte(FALSE);
+}
+
+uint8 SOFT_I2C_getStatus(void)
+{
+	return SOFT_I2C_status;
+}
+
+uint8 SOFT_I2C_recoverBus(void)
+{
+	uint8 i;
+
+	SOFT_I2C_SDA_HIGH();
+	for (i = 0; i < 9 && !SOFT_I2C_SDA_READ(); i++)
+	{
+		SOFT_I2C_SCL_LOW();
+		SOFT_I2C_DELAY();
+		if (SOFT_I2C_releaseScl() == FALSE)
+		{
+			return FALSE; // SCL held low, nothing can be done from the master
+		}
+		SOFT_I2C_DELAY();
+	}
+
+	SOFT_I2C_SCL_LOW();
+	SOFT_I2C_DELAY();
+	SOFT_I2C_busOwned = TRUE; // the STOP is sent whatever the state
+	SOFT_I2C_stop();
+
+	return (SOFT_I2C_SCL_READ() && SOFT_I2C_SDA_READ()) ? TRUE : FALSE;
+}
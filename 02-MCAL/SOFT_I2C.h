@@ -0,0 +1,92 @@
+/******************************************************************************
+ *
+ * Module: Software I2C
+ *
+ * File Name: SOFT_I2C.h
+ *
+ * Description: Header file for the bit-banged I2C master on GPIO pins
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+#ifndef SOFT_I2C_H_
+#define SOFT_I2C_H_
+
+#include "STD_TYPES.h"
+#include "TWI.h" // the status codes are the ones of the hardware TWI
+
+/*************************************************************************************************************
+ * Same functions as the master part of TWI.h on two GPIO pins (SOFT_I2C_config.h), so a driver written
+ * for the TWI runs on a second bus by replacing TWI_xxx with SOFT_I2C_xxx.
+ * The pins are driven as open drain: low = output 0, high = input released to the external pull up,
+ * and the slaves may stretch SCL (up to SOFT_I2C_STRETCH_TIMEOUT_US).
+ * Single master: a lost arbitration is detected and reported (TWI_ARB_LOST) but not retried.
+ * The functions are blocking and don't use interrupts, the bus timing is described in SOFT_I2C_config.h.
+ *************************************************************************************************************/
+
+/*************************************************************************************************************
+ *   										Functions Prototypes										 	 *
+ * ***********************************************************************************************************/
+
+/*
+ * Description : Release SCL and SDA (inputs, pull ups disabled).
+ * arguments   : None
+ * Return      : None
+ */
+void SOFT_I2C_init(void);
+
+/*
+ * Description : Send a START, or a repeated START if the bus is already owned.
+ * arguments   : None
+ * Return      : None
+ * Note        : SOFT_I2C_getStatus : TWI_START, TWI_REP_START, TWI_ARB_LOST (bus busy) or TWI_TIMEOUT
+ */
+void SOFT_I2C_start(void);
+
+/*
+ * Description : Send a STOP and release the bus.
+ * arguments   : None
+ * Return      : None
+ */
+void SOFT_I2C_stop(void);
+
+/*
+ * Description : Send a byte, the first one after a START is the slave address + R/W.
+ * arguments   : uint8 data : byte to be sent
+ * Return      : None
+ * Note        : SOFT_I2C_getStatus : TWI_MT_SLA_W_ACK/NACK, TWI_MT_SLA_R_ACK/NACK, TWI_MT_DATA_ACK/NACK,
+ * 				 TWI_ARB_LOST or TWI_TIMEOUT
+ */
+void SOFT_I2C_writeByte(uint8 data);
+
+/*
+ * Description : Receive a byte and acknowledge it (more bytes follow).
+ * arguments   : None
+ * Return      : uint8 : received byte
+ * Note        : SOFT_I2C_getStatus : TWI_MR_DATA_ACK or TWI_TIMEOUT
+ */
+uint8 SOFT_I2C_readByteWithACK(void);
+
+/*
+ * Description : Receive the last byte of a read (not acknowledged).
+ * arguments   : None
+ * Return      : uint8 : received byte
+ * Note        : SOFT_I2C_getStatus : TWI_MR_DATA_NACK or TWI_TIMEOUT
+ */
+uint8 SOFT_I2C_readByteWithNACK(void);
+
+/*
+ * Description : Status of the last operation, in the codes of the TWSR register (TWI.h).
+ * arguments   : None
+ * Return      : uint8 : status
+ */
+uint8 SOFT_I2C_getStatus(void);
+
+/*
+ * Description : Release a bus held by a slave: up to 9 SCL clocks until SDA is high, then a STOP.
+ * arguments   : None
+ * Return      : uint8 : TRUE if SCL and SDA are both high afterwards, FALSE if the bus is still held
+ */
+uint8 SOFT_I2C_recoverBus(void);
+
+#endif /* SOFT_I2C_H_ */
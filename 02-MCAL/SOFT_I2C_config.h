@@ -0,0 +1,53 @@
+/******************************************************************************
+ *
+ * Module: Software I2C
+ *
+ * File Name: SOFT_I2C_config.h
+ *
+ * Description: Static configuration file for the bit-banged I2C master
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+#ifndef SOFT_I2C_CONFIG_H_
+#define SOFT_I2C_CONFIG_H_
+
+#include "GPIO.h"
+#include "SETTINGS.h" // for F_CPU
+
+/******************* Pins *********************************/
+/* any GPIO pins, the bus needs external pull up resistors (the internal ones can't be used, see SOFT_I2C.h) */
+#define SOFT_I2C_SCL_PORT_ID 		PORTD_ID
+#define SOFT_I2C_SCL_PIN_ID 		PIN4_ID
+#define SOFT_I2C_SDA_PORT_ID 		PORTD_ID
+#define SOFT_I2C_SDA_PIN_ID 		PIN5_ID
+
+/******************* Bit rate *********************************/
+/* upper limit of the SCL frequency, the CPU limits it further (see the table below) */
+#define SOFT_I2C_SCL_FREQUENCY 		100000UL
+
+/* cycles of half a bit of the driver code without delay (port access, clock stretching check, loop) */
+#define SOFT_I2C_HALF_BIT_CYCLES 	10UL
+
+/******************* Clock stretching *********************************/
+/* a slave may hold SCL low up to this time, the operation then fails with TWI_TIMEOUT */
+#define SOFT_I2C_STRETCH_TIMEOUT_US 1000UL
+
+/************************************** Timing ******************************************************
+ * Every bit is: SDA set, delay, SCL released (and waited for while a slave stretches it), SDA read
+ * (arbitration or data), delay, SCL low, so a bit costs 2 * SOFT_I2C_HALF_BIT_CYCLES (about 20 cycles
+ * at -O3, the level of bin/Makefile) plus the two delays. The delays are computed at compile time for
+ * SOFT_I2C_SCL_FREQUENCY, no delay is used when the CPU is slower than the requested rate.
+ *
+ * 	F_CPU		requested		SCL (no stretching)		byte + ACK
+ * 	1 MHz		100 kHz			~50 kHz	(CPU bound)		~180 us
+ * 	8 MHz		100 kHz			100 kHz					90 us
+ * 	8 MHz		400 kHz			~400 kHz (CPU bound)	~23 us
+ * 	16 MHz		100 kHz			100 kHz					90 us
+ * 	16 MHz		400 kHz			400 kHz					23 us
+ *
+ * The figures are estimated from the cycles of the bit loop, Benchmark_SOFT_I2C (APP/Benchmarks)
+ * prints the measured rate of the build. The bus is blocking: the CPU is busy for the whole transfer.
+ ****************************************************************************************************/
+
+#endif /* SOFT_I2C_CONFIG_H_ */
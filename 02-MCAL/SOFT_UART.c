@@ -0,0 +1,302 @@
+/******************************************************************************
+ *
+ * Module: Software UART
+ *
+ * File Name: SOFT_UART.c
+ *
+ * Description: Source file for the timer driven software UART (8N1) on GPIO pins
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+#include "SOFT_UART.h"
+
+#include "BIT_MACROS.h"
+#include "EXTI.h"
+#include "GPIO.h"
+#include "QUEUE.h"
+#include "SOFT_UART_config.h"
+#include "TIMER.h"
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+/*************************** Compile-time bit timing ***************************************/
+/* Timer0 ticks per bit (rounded) for a prescaler */
+#define SOFT_UART_TICKS(prescaler) \
+	(((F_CPU) + (prescaler) * SOFT_UART_BAUD_RATE / 2UL) / ((prescaler) * SOFT_UART_BAUD_RATE))
+
+/* smallest prescaler that fits 1.5 bit times in OCR0 */
+#if ((SOFT_UART_TICKS(1UL) * 3UL / 2UL) <= 255UL)
+	#define SOFT_UART_PRESCALER 	1UL
+	#define SOFT_UART_CLOCK 		F_CPU_CLOCK
+#elif ((SOFT_UART_TICKS(8UL) * 3UL / 2UL) <= 255UL)
+	#define SOFT_UART_PRESCALER 	8UL
+	#define SOFT_UART_CLOCK 		F_CPU_8
+#elif ((SOFT_UART_TICKS(64UL) * 3UL / 2UL) <= 255UL)
+	#define SOFT_UART_PRESCALER 	64UL
+	#define SOFT_UART_CLOCK 		F_CPU_64
+#elif ((SOFT_UART_TICKS(256UL) * 3UL / 2UL) <= 255UL)
+	#define SOFT_UART_PRESCALER 	256UL
+	#define SOFT_UART_CLOCK 		F_CPU_256
+#elif ((SOFT_UART_TICKS(1024UL) * 3UL / 2UL) <= 255UL)
+	#define SOFT_UART_PRESCALER 	1024UL
+	#define SOFT_UART_CLOCK 		F_CPU_1024
+#else
+	#error "SOFT_UART_BAUD_RATE is too low for F_CPU"
+#endif
+
+#define SOFT_UART_BIT_TICKS 		SOFT_UART_TICKS(SOFT_UART_PRESCALER)
+#define SOFT_UART_ACTUAL_BAUD 		((F_CPU) / (SOFT_UART_PRESCALER * SOFT_UART_BIT_TICKS))
+#define SOFT_UART_BAUD_ERROR                                                                   \
+	((SOFT_UART_ACTUAL_BAUD > SOFT_UART_BAUD_RATE)                                             \
+		 ? ((SOFT_UART_ACTUAL_BAUD - SOFT_UART_BAUD_RATE) * 1000UL / SOFT_UART_BAUD_RATE)      \
+		 : ((SOFT_UART_BAUD_RATE - SOFT_UART_ACTUAL_BAUD) * 1000UL / SOFT_UART_BAUD_RATE))
+
+#if (SOFT_UART_BAUD_ERROR > SOFT_UART_MAX_BAUD_ERROR)
+	#error "SOFT_UART_BAUD_RATE can't be generated from F_CPU within SOFT_UART_MAX_BAUD_ERROR"
+#endif
+
+/* delay from the start bit edge to the middle of data bit 0 */
+#define SOFT_UART_LATENCY_TICKS 	(SOFT_UART_RX_LATENCY_CYCLES / SOFT_UART_PRESCALER)
+#if ((SOFT_UART_BIT_TICKS * 3UL / 2UL) <= (SOFT_UART_BIT_TICKS + SOFT_UART_LATENCY_TICKS))
+	#error "SOFT_UART_BAUD_RATE is too high, the start bit latency reaches data bit 0"
+#endif
+#define SOFT_UART_FIRST_TICKS 		((SOFT_UART_BIT_TICKS * 3UL / 2UL) - SOFT_UART_LATENCY_TICKS)
+
+/*************************** RX pin of the external interrupt ***************************************/
+#if (SOFT_UART_RX_INT == SOFT_UART_RX_INT0)
+	#define SOFT_UART_RX_PORT_ID 	PORTD_ID
+	#define SOFT_UART_RX_PIN_ID 	PIN2_ID
+	#define SOFT_UART_RX_INTF 		INTF0
+#elif (SOFT_UART_RX_INT == SOFT_UART_RX_INT1)
+	#define SOFT_UART_RX_PORT_ID 	PORTD_ID
+	#define SOFT_UART_RX_PIN_ID 	PIN3_ID
+	#define SOFT_UART_RX_INTF 		INTF1
+#elif (SOFT_UART_RX_INT == SOFT_UART_RX_INT2)
+	#define SOFT_UART_RX_PORT_ID 	PORTB_ID
+	#define SOFT_UART_RX_PIN_ID 	PIN2_ID
+	#define SOFT_UART_RX_INTF 		INTF2
+#else
+	#error "SOFT_UART_RX_INT must be SOFT_UART_RX_INT0, SOFT_UART_RX_INT1 or SOFT_UART_RX_INT2"
+#endif
+
+/*************************** Driver state ***************************************/
+typedef enum
+{
+	SOFT_UART_IDLE,		 // waiting for a start bit or a queued byte
+	SOFT_UART_SENDING,	 // the bit timer shifts out SOFT_UART_shift
+	SOFT_UART_RECEIVING	 // the bit timer samples into SOFT_UART_shift
+} SOFT_UART_StateType;
+
+/* TX: produced by SOFT_UART_WriteByte, consumed by the bit timer. RX: the other way round */
+QUEUE_DEFINE(SOFT_UART_TxQueue, uint8, SOFT_UART_TX_BUFFER_SIZE)
+QUEUE_DEFINE(SOFT_UART_RxQueue, uint8, SOFT_UART_RX_BUFFER_SIZE)
+
+static volatile SOFT_UART_StateType SOFT_UART_state = SOFT_UART_IDLE;
+static uint8 SOFT_UART_shift = 0;	  // byte being sent or received (ISR only)
+static uint8 SOFT_UART_bit = 0;		  // bits done of the current frame (ISR only)
+static uint8 SOFT_UART_txLevel = 0;	  // level of the next TX bit, written first thing in the tick
+static volatile uint16 SOFT_UART_errors = 0;
+
+static Interrupt_ConfigType SOFT_UART_RxInt_Config = {(EXTI_Interrupt)SOFT_UART_RX_INT, falling_edge};
+
+/*************************************************************************************************************
+ *   										Private Functions											 	 *
+ *************************************************************************************************************/
+/* Restart the bit timer so its next compare match is a_ticks from now */
+static void SOFT_UART_RestartTimer(uint8 a_ticks)
+{
+	Timer0_WriteToOCR0(a_ticks - 1);
+	Timer0_WriteToTCNT0(0);
+	TIFR = BIT(OCF0); // drop a compare match of the previous frame
+	Timer0_OC_InterruptEnable();
+}
+
+/* Drive the start bit of the next queued byte (interrupts disabled or from the ISR) */
+static void SOFT_UART_StartTx(void)
+{
+	uint8 data;
+
+	SOFT_UART_TxQueue_Pop(&data);
+	GPIO_writePin(SOFT_UART_TX_PORT_ID, SOFT_UART_TX_PIN_ID, LOGIC_LOW);
+	SOFT_UART_RestartTimer(SOFT_UART_BIT_TICKS);
+
+	SOFT_UART_shift = data;
+	SOFT_UART_bit = 0;
+	SOFT_UART_txLevel = data & 1U;
+	SOFT_UART_state = SOFT_UART_SENDING;
+}
+
+/* The frame is done: send the next queued byte or wait for a start bit */
+static void SOFT_UART_FrameDone(void)
+{
+	if (SOFT_UART_TxQueue_Count() != 0)
+	{
+		SOFT_UART_StartTx();
+		return;
+	}
+
+	Timer0_OC_InterruptDisable();
+	SOFT_UART_state = SOFT_UART_IDLE;
+
+	GIFR = BIT(SOFT_UART_RX_INTF); // edges of the finished frame are not start bits
+	EXTI_enable(&SOFT_UART_RxInt_Config);
+}
+
+/*************************** Start bit (EXTI call back) ***************************/
+static void SOFT_UART_StartBit(void)
+{
+	EXTI_disable(&SOFT_UART_RxInt_Config); // the data bits are sampled by the timer
+	SOFT_UART_RestartTimer(SOFT_UART_FIRST_TICKS);
+
+	SOFT_UART_shift = 0;
+	SOFT_UART_bit = 0;
+	SOFT_UART_state = SOFT_UART_RECEIVING;
+}
+
+/*************************** Bit timer (Timer0 compare match call back) ***************************/
+static void SOFT_UART_BitTick(void)
+{
+	uint8 level;
+
+	if (SOFT_UART_state == SOFT_UART_SENDING)
+	{
+		if (SOFT_UART_bit == 9)
+		{
+			SOFT_UART_FrameDone(); // the stop bit is complete
+			return;
+		}
+
+		// the bit level is prepared by the previous tick, so the edge jitter does not depend on the bit
+		GPIO_writePin(SOFT_UART_TX_PORT_ID, SOFT_UART_TX_PIN_ID, SOFT_UART_txLevel);
+		SOFT_UART_bit++;
+		SOFT_UART_shift >>= 1;
+		SOFT_UART_txLevel = (SOFT_UART_bit < 8) ? (SOFT_UART_shift & 1U) : LOGIC_HIGH; // data bits then stop bit
+	}
+	else if (SOFT_UART_state == SOFT_UART_RECEIVING)
+	{
+		level = GPIO_readPin(SOFT_UART_RX_PORT_ID, SOFT_UART_RX_PIN_ID);
+
+		if (SOFT_UART_bit == 0)
+		{
+			Timer0_WriteToOCR0(SOFT_UART_BIT_TICKS - 1); // from the middle of bit 0, one bit time per tick
+		}
+
+		if (SOFT_UART_bit < 8)
+		{
+			SOFT_UART_shift >>= 1; // LSB first
+			if (level == LOGIC_HIGH)
+			{
+				SOFT_UART_shift |= 0x80;
+			}
+			SOFT_UART_bit++;
+		}
+		else
+		{
+			// middle of the stop bit
+			if (level != LOGIC_HIGH || SOFT_UART_RxQueue_Push(SOFT_UART_shift) == FALSE)
+			{
+				SOFT_UART_errors++;
+			}
+			SOFT_UART_FrameDone();
+		}
+	}
+}
+
+/*************************************************************************************************************
+ *   										Functions Definitions										 	 *
+ *************************************************************************************************************/
+void SOFT_UART_init(void)
+{
+	Timer0_ConfigType SOFT_UART_Timer0_Config = {0, TIMER0_CTC_MODE, SOFT_UART_CLOCK, OC0_DISCONNECTED};
+
+	// TX idle level is high
+	GPIO_writePin(SOFT_UART_TX_PORT_ID, SOFT_UART_TX_PIN_ID, LOGIC_HIGH);
+	GPIO_setupPinDirection(SOFT_UART_TX_PORT_ID, SOFT_UART_TX_PIN_ID, PIN_OUTPUT);
+
+	// RX input with pull up, an unconnected line stays idle
+	GPIO_setupPinDirection(SOFT_UART_RX_PORT_ID, SOFT_UART_RX_PIN_ID, PIN_INPUT);
+	GPIO_writePin(SOFT_UART_RX_PORT_ID, SOFT_UART_RX_PIN_ID, LOGIC_HIGH);
+
+	SOFT_UART_state = SOFT_UART_IDLE;
+	SOFT_UART_errors = 0;
+
+	Timer0_OC_InterruptDisable();
+	Timer0_Oc_SetCallBack(SOFT_UART_BitTick);
+	Timer0_init(&SOFT_UART_Timer0_Config);
+
+	EXTI_init(&SOFT_UART_RxInt_Config);
+	EXTI_setCallBack(&SOFT_UART_RxInt_Config, SOFT_UART_StartBit);
+	GIFR = BIT(SOFT_UART_RX_INTF);
+	EXTI_enable(&SOFT_UART_RxInt_Config);
+}
+
+uint8 SOFT_UART_WriteByte(uint8 a_data)
+{
+	uint8 sreg;
+
+	if (SOFT_UART_TxQueue_Push(a_data) == FALSE)
+	{
+		return FALSE;
+	}
+
+	// start the transmission if the bit timer is free, otherwise FrameDone picks the byte up
+	sreg = SREG;
+	cli();
+	if (SOFT_UART_state == SOFT_UART_IDLE)
+	{
+		EXTI_disable(&SOFT_UART_RxInt_Config); // half-duplex
+		SOFT_UART_StartTx();
+	}
+	SREG = sreg;
+	return TRUE;
+}
+
+uint8 SOFT_UART_ReadByte(uint8 *ptr_data)
+{
+	return SOFT_UART_RxQueue_Pop(ptr_data);
+}
+
+void SOFT_UART_SendByte(uint8 a_data)
+{
+	while (SOFT_UART_WriteByte(a_data) == FALSE) // wait only while the TX buffer is full
+		;
+}
+
+uint8 SOFT_UART_ReceiveByte(void)
+{
+	uint8 data;
+	while (SOFT_UART_ReadByte(&data) == FALSE)
+		;
+	return data;
+}
+
+void SOFT_UART_SendString(const uint8 *Str)
+{
+	while (*Str != '\0')
+	{
+		SOFT_UART_SendByte(*Str);
+		Str++;
+	}
+}
+
+uint8 SOFT_UART_GetTxFree(void)
+{
+	return SOFT_UART_TxQueue_Free();
+}
+
+uint8 SOFT_UART_GetRxAvailable(void)
+{
+	return SOFT_UART_RxQueue_Count();
+}
+
+uint16 SOFT_UART_GetErrorCount(void)
+{
+	uint16 errors;
+	uint8 sreg = SREG; // 16-bit counter updated from the ISR
+	cli();
+	errors = SOFT_UART_errors;
+	SREG = sreg;
+	return errors;
+}
@@ -0,0 +1,100 @@
+/******************************************************************************
+ *
+ * Module: Software UART
+ *
+ * File Name: SOFT_UART.h
+ *
+ * Description: Header file for the timer driven software UART (8N1) on GPIO pins
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+#ifndef SOFT_UART_H_
+#define SOFT_UART_H_
+
+#include "STD_TYPES.h"
+
+/*************************************************************************************************************
+ * Timer0 compare match interrupt clocks every bit (TX and RX) and the RX start bit is detected by an
+ * external interrupt (SOFT_UART_RX_INT), so both are owned by this driver while it is used
+ * (Timer0 can't drive the DCMOTOR PWM at the same time).
+ * The link is half-duplex: there is a single bit timer, so a byte is either sent or received at a time.
+ * Queued TX bytes wait until the byte being received is complete, and a start bit that arrives while
+ * a byte is being sent is missed, so the other device must not talk while this one sends
+ * (request/response protocols, diagnostics output).
+ * The timing of every F_CPU is described in SOFT_UART_config.h.
+ *************************************************************************************************************/
+
+/*************************************************************************************************************
+ *   										Functions Prototypes										 	 *
+ * ***********************************************************************************************************/
+
+/*
+ * Description : Initialize the software UART: TX pin idle high, RX pin input with pull up,
+ * 				 Timer0 in CTC mode at the bit rate of SOFT_UART_BAUD_RATE and the start bit interrupt.
+ * arguments   : None
+ * Return      : None
+ * Note        : the global interrupts must be enabled
+ */
+void SOFT_UART_init(void);
+
+/*
+ * Description : Queue one byte to be sent.
+ * arguments   : uint8 a_data : data to be sent
+ * Return      : uint8 : status of the function [TRUE, FALSE (the TX buffer is full)]
+ * Note        : this function is non-blocking function
+ */
+uint8 SOFT_UART_WriteByte(uint8 a_data);
+
+/*
+ * Description : Get the oldest received byte.
+ * arguments   : uint8 *ptr_data : pointer to the variable to store the received data
+ * Return      : uint8 : status of the function [TRUE, FALSE (no data received)]
+ * Note        : this function is non-blocking function
+ */
+uint8 SOFT_UART_ReadByte(uint8 *ptr_data);
+
+/*
+ * Description : Send one byte, waiting only while the TX buffer is full.
+ * arguments   : uint8 a_data : data to be sent
+ * Return      : None
+ */
+void SOFT_UART_SendByte(uint8 a_data);
+
+/*
+ * Description : Wait until a byte is received and return it.
+ * arguments   : None
+ * Return      : uint8 : received data
+ * Note        : this function is blocking function
+ */
+uint8 SOFT_UART_ReceiveByte(void);
+
+/*
+ * Description : Send a null terminated string, waiting only while the TX buffer is full.
+ * arguments   : const uint8 *Str : pointer to the string to be sent
+ * Return      : None
+ */
+void SOFT_UART_SendString(const uint8 *Str);
+
+/*
+ * Description : Number of free places in the TX buffer.
+ * arguments   : None
+ * Return      : uint8 : free places
+ */
+uint8 SOFT_UART_GetTxFree(void);
+
+/*
+ * Description : Number of received bytes waiting in the RX buffer.
+ * arguments   : None
+ * Return      : uint8 : queued bytes
+ */
+uint8 SOFT_UART_GetRxAvailable(void);
+
+/*
+ * Description : Number of received frames dropped because of a missing stop bit or a full RX buffer
+ * arguments   : None
+ * Return      : uint16 : dropped frames since SOFT_UART_init
+ */
+uint16 SOFT_UART_GetErrorCount(void);
+
+#endif /* SOFT_UART_H_ */
@@ -0,0 +1,68 @@
+/******************************************************************************
+ *
+ * Module: Software UART
+ *
+ * File Name: SOFT_UART_config.h
+ *
+ * Description: Static configuration file for the timer driven software UART
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+#ifndef SOFT_UART_CONFIG_H_
+#define SOFT_UART_CONFIG_H_
+
+#include "GPIO.h"
+#include "SETTINGS.h" // for F_CPU
+
+/******************* Frame and baud rate *********************************/
+/* the frame is fixed to 8N1 (start bit, 8 data bits LSB first, 1 stop bit) */
+#define SOFT_UART_BAUD_RATE 		2400UL
+#define SOFT_UART_MAX_BAUD_ERROR 	20 /* in 0.1 % units, the build fails above it */
+
+/******************* Pins *********************************/
+/* TX can be any GPIO pin */
+#define SOFT_UART_TX_PORT_ID 		PORTD_ID
+#define SOFT_UART_TX_PIN_ID 		PIN7_ID
+
+/* RX must be an external interrupt pin */
+#define SOFT_UART_RX_INT 			SOFT_UART_RX_INT1
+
+#define SOFT_UART_RX_INT0 			0 /* PD2 */
+#define SOFT_UART_RX_INT1 			1 /* PD3 */
+#define SOFT_UART_RX_INT2 			2 /* PB2 */
+
+/******************* Buffers *********************************/
+/* sizes must be a power of two (2 .. 128), see QUEUE.h */
+#define SOFT_UART_TX_BUFFER_SIZE 	16
+#define SOFT_UART_RX_BUFFER_SIZE 	16
+
+/******************* Start bit latency *********************************/
+/*
+ * Cycles from the start bit edge to the timer restart in the EXTI call back
+ * (interrupt response + EXTI ISR + call back prologue), subtracted from the first
+ * 1.5 bit delay so the data bits are sampled in their middle.
+ */
+#define SOFT_UART_RX_LATENCY_CYCLES 60UL
+
+/************************************** Timing ******************************************************
+ * Timer0 runs in CTC mode with one compare match per bit, the prescaler is the smallest one
+ * that fits 1.5 bit times (the delay to the middle of data bit 0) in OCR0.
+ * One bit interrupt (Timer0 call back + GPIO access) costs about 90 cycles, so the bit time should
+ * be at least 4 times that to leave CPU time for the application and the other interrupts.
+ *
+ * 	F_CPU		baud		prescaler	ticks/bit	error		CPU load while active
+ * 	1 MHz		2400		8			52			0.16 %		22 %	<- maximum sustainable
+ * 	1 MHz		4800		8			26			0.16 %		43 %
+ * 	8 MHz		9600		8			104			0.16 %		11 %
+ * 	8 MHz		19200		8			52			0.16 %		22 %	<- maximum sustainable
+ * 	8 MHz		38400		8			26			0.16 %		43 %
+ * 	16 MHz		19200		8			104			0.16 %		11 %
+ * 	16 MHz		38400		8			52			0.16 %		22 %	<- maximum sustainable
+ * 	16 MHz		57600		8			35			0.79 %		32 %
+ * 	16 MHz		115200		1			139			0.08 %		65 %	(TX only, RX misses bytes)
+ *
+ * The error is the generated bit rate against SOFT_UART_BAUD_RATE, the other device adds its own.
+ ****************************************************************************************************/
+
+#endif /* SOFT_UART_CONFIG_H_ */
@@ -20,6 +20,9 @@
 
 static void (*SPI_callBackPtr)(void) = NULL_PTR;
 
+/* device whose settings are in SPCR/SPSR, NULL_PTR after SPI_init */
+static const SPI_DeviceType *SPI_activeDevice = NULL_PTR;
+
 /******************************************* initialization  *********************************************/
 void SPI_init(Master_Slave_Select_t Master_Slave_Select, Clock_Rate_t Clock_Rate)
 {
@@ -90,6 +93,50 @@ void SPI_init(Master_Slave_Select_t Master_Slave_Select, Clock_Rate_t Clock_Rate
 #elif SPI_STATE == SPI_DISABLE
 	CLEAR_BIT(SPCR, SPE);
 #endif
+
+	SPI_activeDevice = NULL_PTR; // the static configuration is on the bus now
+}
+
+/****************************************** Multi-device bus ************************************************/
+void SPI_Device_init(SPI_DeviceType *a_device)
+{
+	uint8 spcr = BIT(SPE) | BIT(MSTR) | (a_device->clockRate & 0x03);
+
+	if (a_device->bitOrder == SPI_LSB_FIRST)
+	{
+		SET_BIT(spcr, DORD);
+	}
+	if (a_device->mode == SPI_MODE_2 || a_device->mode == SPI_MODE_3)
+	{
+		SET_BIT(spcr, CPOL);
+	}
+	if (a_device->mode == SPI_MODE_1 || a_device->mode == SPI_MODE_3)
+	{
+		SET_BIT(spcr, CPHA);
+	}
+
+	a_device->spcr = spcr;
+	a_device->spsr = (a_device->doubleSpeed == TRUE) ? BIT(SPI2X) : 0;
+
+	GPIO_writePin(a_device->csPort, a_device->csPin, LOGIC_HIGH);
+	GPIO_setupPinDirection(a_device->csPort, a_device->csPin, PIN_OUTPUT);
+}
+
+void SPI_select(const SPI_DeviceType *a_device)
+{
+	if (a_device != SPI_activeDevice)
+	{
+		// keep the interrupt enable of the transaction queue
+		SPCR = a_device->spcr | (SPCR & BIT(SPIE));
+		SPSR = a_device->spsr; // only SPI2X is writable
+		SPI_activeDevice = a_device;
+	}
+	GPIO_writePin(a_device->csPort, a_device->csPin, LOGIC_LOW);
+}
+
+void SPI_deselect(const SPI_DeviceType *a_device)
+{
+	GPIO_writePin(a_device->csPort, a_device->csPin, LOGIC_HIGH);
 }
 
 /**************************************** Interrupt Enable/Disable ********************************************/
@@ -146,7 +193,7 @@ uint8 SPI_ReceiveByte(void)
 uint8 SPI_ReceiveByteCheck(uint8 *ptr_data)
 {
 	uint8 status = FALSE;
-	if (IS_BIT_CLEAR(SPSR, SPIF))
+	if (IS_BIT_SET(SPSR, SPIF)) // a byte is complete
 	{
 		*ptr_data = SPDR;
 		status = TRUE;
@@ -154,6 +201,101 @@ uint8 SPI_ReceiveByteCheck(uint8 *ptr_data)
 	return status;
 }
 
+/********************************** Block transfer functions with polling ****************************************/
+/*
+ * SPDR is single buffered for transmit and double buffered for receive: as soon as SPIF is set the
+ * next byte is written (which also clears SPIF), then the previous received byte is read while
+ * the next one is being shifted. The byte to send is prepared before waiting for SPIF.
+ */
+void SPI_transferBlock(const uint8 *a_tx, uint8 *a_rx, uint16 a_length)
+{
+	uint16 i;
+	uint8 next;
+
+	if (a_tx == NULL_PTR)
+	{
+		if (a_rx != NULL_PTR)
+		{
+			SPI_receiveBlock(a_rx, a_length);
+		}
+		else
+		{
+			while (a_length-- > 0) // clock only
+			{
+				SPI_SendByte(SPI_DEFAULT_DATA_VALUE);
+			}
+		}
+		return;
+	}
+	if (a_rx == NULL_PTR)
+	{
+		SPI_sendBlock(a_tx, a_length);
+		return;
+	}
+	if (a_length == 0)
+	{
+		return;
+	}
+
+	SPDR = a_tx[0];
+	for (i = 1; i < a_length; i++)
+	{
+		next = a_tx[i];
+		while (IS_BIT_CLEAR(SPSR, SPIF))
+			;
+		SPDR = next;
+		a_rx[i - 1] = SPDR; // byte i - 1 from the receive buffer, byte i is shifting
+	}
+	while (IS_BIT_CLEAR(SPSR, SPIF))
+		;
+	a_rx[a_length - 1] = SPDR;
+}
+
+void SPI_sendBlock(const uint8 *a_tx, uint16 a_length)
+{
+	const uint8 *end = a_tx + a_length;
+	uint8 next;
+
+	if (a_length == 0)
+	{
+		return;
+	}
+
+	SPDR = *a_tx++;
+	while (a_tx != end)
+	{
+		next = *a_tx++;
+		while (IS_BIT_CLEAR(SPSR, SPIF))
+			;
+		SPDR = next; // also clears SPIF
+	}
+	while (IS_BIT_CLEAR(SPSR, SPIF))
+		;
+	(void)SPDR; // clear SPIF of the last byte
+}
+
+void SPI_receiveBlock(uint8 *a_rx, uint16 a_length)
+{
+	uint8 *end = a_rx + a_length - 1;
+
+	if (a_length == 0)
+	{
+		return;
+	}
+
+	SPDR = SPI_DEFAULT_DATA_VALUE;
+	while (a_rx != end)
+	{
+		while (IS_BIT_CLEAR(SPSR, SPIF))
+			;
+		SPDR = SPI_DEFAULT_DATA_VALUE;
+		*a_rx++ = SPDR;
+	}
+	while (IS_BIT_CLEAR(SPSR, SPIF))
+		;
+	*a_rx = SPDR;
+}
+
 /********************************* Send and receive functions with no ckecking - for interrupt - *******************/
 void SPI_SendByteNoBlock(uint8 a_data)
 {
@@ -15,6 +15,9 @@
 
 #include "STD_TYPES.h"
 
+/* byte clocked out when only receiving */
+#define SPI_DEFAULT_DATA_VALUE 0xFF
+
 /*******************************************************************************
  *                    Module Data Types                                        *
  * *****************************************************************************/
@@ -33,6 +36,37 @@ typedef enum
 	SPI_FOSC_128,
 } Clock_Rate_t;
 
+typedef enum
+{
+	SPI_MODE_0, // CPOL = 0, CPHA = 0 : idle low, sample on the leading (rising) edge
+	SPI_MODE_1, // CPOL = 0, CPHA = 1 : idle low, sample on the trailing (falling) edge
+	SPI_MODE_2, // CPOL = 1, CPHA = 0 : idle high, sample on the leading (falling) edge
+	SPI_MODE_3	// CPOL = 1, CPHA = 1 : idle high, sample on the trailing (rising) edge
+} SPI_Mode_t;
+
+typedef enum
+{
+	SPI_MSB_FIRST,
+	SPI_LSB_FIRST
+} SPI_BitOrder_t;
+
+/*
+ * A chip on the SPI bus (master only). Fill the first fields and call SPI_Device_init once,
+ * then every access goes through SPI_select/SPI_deselect which reprogram SPCR/SPSR only when
+ * the selected device is not the one of the last access.
+ */
+typedef struct
+{
+	uint8 csPort;			 // chip select pin, active low
+	uint8 csPin;
+	SPI_Mode_t mode;
+	Clock_Rate_t clockRate;
+	boolean doubleSpeed;	 // TRUE -> clock rate x2 (SPI2X)
+	SPI_BitOrder_t bitOrder;
+	uint8 spcr;				 // register images computed by SPI_Device_init
+	uint8 spsr;
+} SPI_DeviceType;
+
 /*******************************************************************************
  *                    Functions Prototypes                                     *
  *******************************************************************************/
@@ -83,6 +117,57 @@ uint8 SPI_ReceiveByte(void);
  */
 uint8 SPI_ReceiveByteCheck(uint8 *ptr_data);
 
+/*
+ * Description : Send and receive a block of bytes (master), every byte is written to SPDR as soon as
+ * 				 the previous one is shifted, so the bus gap is only a few cycles per byte.
+ * arguments   : const uint8 *a_tx : bytes to send, NULL_PTR -> send SPI_DEFAULT_DATA_VALUE
+ * 				 uint8 *a_rx : buffer for the received bytes, NULL_PTR -> discard them
+ * 				 uint16 a_length : number of bytes, any value including 0x00, 0xFF and '#'
+ * Return  : None
+ * Note : this function is blocking function - busy waiting polling method -
+ */
+void SPI_transferBlock(const uint8 *a_tx, uint8 *a_rx, uint16 a_length);
+
+/*
+ * Description : Send a block of bytes and discard the received ones.
+ * arguments   : const uint8 *a_tx : bytes to send
+ * 				 uint16 a_length : number of bytes
+ * Return  : None
+ */
+void SPI_sendBlock(const uint8 *a_tx, uint16 a_length);
+
+/*
+ * Description : Receive a block of bytes, SPI_DEFAULT_DATA_VALUE is sent for every byte.
+ * arguments   : uint8 *a_rx : buffer for the received bytes (a_length bytes)
+ * 				 uint16 a_length : number of bytes
+ * Return  : None
+ */
+void SPI_receiveBlock(uint8 *a_rx, uint16 a_length);
+
+/****************************************** Multi-device bus ************************************************/
+/*
+ * Description : Prepare a device descriptor: compute its SPCR/SPSR images and set its CS pin as a high output.
+ * arguments   : SPI_DeviceType *a_device : descriptor with csPort, csPin, mode, clockRate, doubleSpeed and bitOrder
+ * Return  : None
+ * Note : SPI_init(SPI_Master, ...) must be called first (bus pins)
+ */
+void SPI_Device_init(SPI_DeviceType *a_device);
+
+/*
+ * Description : Switch the bus to the device settings (only if another device was used last) and drive its CS low.
+ * arguments   : const SPI_DeviceType *a_device : the device to talk to
+ * Return  : None
+ * Note : the bus must be idle (no byte shifting)
+ */
+void SPI_select(const SPI_DeviceType *a_device);
+
+/*
+ * Description : Release the CS of the device (drive it high), the bus settings are kept for the next access.
+ * arguments   : const SPI_DeviceType *a_device : the selected device
+ * Return  : None
+ */
+void SPI_deselect(const SPI_DeviceType *a_device);
+
 /**************************************** Interrupt Enable/Disable ********************************************/
 void SPI_EnableInterrupt(void);
 void SPI_DisableInterrupt(void);
@@ -20,6 +20,41 @@
 #define SPI_STATE 				SPI_ENABLE
 #define SPI_Double_SPEED 		SPI_Double_SPEED_OFF
 
+/******************* Slave engine (SPI_Slave_init) ***************************/
+/*
+ * SS (PB4) has no edge interrupt, it must also be wired to the external interrupt pin
+ * SPI_SLAVE_SS_INT to delimit the frames.
+ */
+#define SPI_SLAVE_SS_INT 			SPI_SLAVE_SS_INT2
+#define SPI_SLAVE_RX_BUFFER_SIZE 	32	 /* power of two (<= 128) */
+#define SPI_SLAVE_TX_BUFFER_SIZE 	32	 /* power of two (<= 128) */
+#define SPI_SLAVE_FRAME_QUEUE_SIZE 	8	 /* received frames waiting for SPI_Slave_ReadFrame, power of two */
+#define SPI_SLAVE_IDLE_BYTE 		0xFF /* sent when no response byte is queued */
+
+/*
+ * Minimum gaps the master must leave, in slave CPU cycles (estimated at -O3 with a margin for
+ * one other short interrupt running on the slave):
+ * 	BYTE_GAP: from the end of a byte to the first SCK edge of the next one, the STC interrupt
+ * 			  (entry, call back, SPDR read and the preload of the response) must run in between.
+ * 			  SCK itself doesn't help: the response must be in SPDR before the byte starts.
+ * 	SS_GAP:   SS high time between two frames, the SS edge interrupt reprograms the EXTI.
+ */
+#define SPI_SLAVE_BYTE_GAP_CYCLES 	200UL
+#define SPI_SLAVE_SS_GAP_CYCLES 	300UL
+
+/*
+ * Data ready output: driven low from SPI_Slave_WriteByte until the last queued response byte is
+ * loaded in SPDR, so the master only clocks the slave when it has something to send
+ * (it must clock one more byte after the pin goes high). SPI_DISABLE frees the pin.
+ */
+#define SPI_SLAVE_DRDY 				SPI_ENABLE
+#define SPI_SLAVE_DRDY_PORT_ID 		PORTA_ID
+#define SPI_SLAVE_DRDY_PIN_ID 		PIN3_ID
+
+#define SPI_SLAVE_SS_INT0 			0 /* PD2 */
+#define SPI_SLAVE_SS_INT1 			1 /* PD3 */
+#define SPI_SLAVE_SS_INT2 			2 /* PB2 */
+
 /********** Data Order **************/
 #define LSB 					0
 #define MSB 					1
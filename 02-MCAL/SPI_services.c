@@ -11,7 +11,48 @@
  *******************************************************************************/
 #include "SPI_services.h"
 
+#include "BIT_MACROS.h"
+#include "EXTI.h"
+#include "GPIO.h"
+#include "QUEUE.h"
+#include "SPI_config.h"
+
 #include "SETTINGS.h" // for F_CPU
+#include <avr/interrupt.h>
+
+/* produced by SPI_SubmitTransaction, consumed by the SPI_STC_vect call back */
+QUEUE_DEFINE(SPI_TransactionQueue, SPI_TransactionType, SPI_TRANSACTION_QUEUE_SIZE)
+
+static volatile boolean SPI_Transaction_busy = FALSE;
+static uint8 SPI_Transaction_index = 0; // byte of the running transaction in the shift register (ISR only)
+
+/*************************** Slave engine ***************************/
+#if (SPI_SLAVE_SS_INT == SPI_SLAVE_SS_INT0)
+	#define SPI_SLAVE_SS_INTF INTF0
+#elif (SPI_SLAVE_SS_INT == SPI_SLAVE_SS_INT1)
+	#define SPI_SLAVE_SS_INTF INTF1
+#elif (SPI_SLAVE_SS_INT == SPI_SLAVE_SS_INT2)
+	#define SPI_SLAVE_SS_INTF INTF2
+#else
+	#error "SPI_SLAVE_SS_INT must be SPI_SLAVE_SS_INT0, SPI_SLAVE_SS_INT1 or SPI_SLAVE_SS_INT2"
+#endif
+
+/* RX bytes and frame lengths are produced by the ISRs, TX bytes are consumed by the STC ISR */
+QUEUE_DEFINE(SPI_Slave_RxQueue, uint8, SPI_SLAVE_RX_BUFFER_SIZE)
+QUEUE_DEFINE(SPI_Slave_TxQueue, uint8, SPI_SLAVE_TX_BUFFER_SIZE)
+QUEUE_DEFINE(SPI_Slave_FrameQueue, uint8, SPI_SLAVE_FRAME_QUEUE_SIZE)
+
+static uint8 SPI_Slave_nextTx = SPI_SLAVE_IDLE_BYTE; // response for the byte after the one in SPDR
+static uint8 SPI_Slave_frameLength = 0;				 // queued bytes of the running frame
+static volatile uint16 SPI_Slave_errors = 0;
+
+/* INT0/INT1 report both edges, INT2 only one so its edge is toggled after every interrupt */
+static Interrupt_ConfigType SPI_Slave_SS_Config = {(EXTI_Interrupt)SPI_SLAVE_SS_INT,
+#if (SPI_SLAVE_SS_INT == SPI_SLAVE_SS_INT2)
+												   falling_edge};
+#else
+												   any_logical_change};
+#endif
 
 /*************************************************************************************************************
  *   										Functions Definitions										 	 *
@@ -19,19 +60,15 @@
 
 void SPI_sendString(const uint8 *str)
 {
-	uint8 i = 0;
-	uint8 received_data = 0;
+	uint16 length = 0;
 
-	/* Send the whole string */
-	while (str[i] != '\0')
+	while (str[length] != '\0')
 	{
-		/*
-		 * received_data contains the received data from the other device.
-		 * It is a dummy data variable as we just need to send the string to other device.
-		 */
-		received_data = SPI_sendReceiveByte(str[i]);
-		i++;
+		length++;
 	}
+
+	/* the received bytes are dummy data as we just need to send the string to other device */
+	SPI_sendBlock(str, length);
 }
 
 void SPI_receiveString(uint8 *str) // receive until '#'
@@ -51,3 +88,239 @@ void SPI_receiveString(uint8 *str) // receive until '#'
 	/* After receiving the whole string plus the '#', replace the '#' with '\0' */
 	str[i] = '\0';
 }
+
+/**********************************************************************************************
+ * 										 	Transaction queue								  *
+ **********************************************************************************************/
+/* Select the device of the transaction at the tail and write its first byte (interrupts disabled or ISR) */
+static void SPI_Transaction_Start(const volatile SPI_TransactionType *a_transaction)
+{
+	SPI_Transaction_index = 0;
+	SPI_select(a_transaction->device); // bus settings of the device, then CS low
+	SPI_SendByteNoBlock((a_transaction->txBuffer != NULL_PTR) ? a_transaction->txBuffer[0] : SPI_DEFAULT_DATA_VALUE);
+}
+
+/*************************** ISR for SPI Serial Transfer Complete ***************************/
+static void SPI_Transaction_ISR(void)
+{
+	const volatile SPI_TransactionType *transaction = SPI_TransactionQueue_Peek();
+	void (*callBack)(void);
+	uint8 index = SPI_Transaction_index;
+	uint8 data = SPI_ReceiveByteNoBlock(); // reading SPDR after SPIF clears the flag
+
+	if (transaction == NULL_PTR)
+	{
+		return; // not started by the queue
+	}
+
+	if (transaction->rxBuffer != NULL_PTR)
+	{
+		transaction->rxBuffer[index] = data;
+	}
+	index++;
+
+	if (index < transaction->length)
+	{
+		// next byte right away, the shift register is idle until SPDR is written
+		SPI_SendByteNoBlock((transaction->txBuffer != NULL_PTR) ? transaction->txBuffer[index] : SPI_DEFAULT_DATA_VALUE);
+		SPI_Transaction_index = index;
+		return;
+	}
+
+	/* transaction complete */
+	SPI_deselect(transaction->device);
+	callBack = transaction->callBack;
+	SPI_TransactionQueue_Drop(); // the descriptor can be reused from now on
+
+	if (callBack != NULL_PTR)
+	{
+		callBack();
+	}
+
+	transaction = SPI_TransactionQueue_Peek();
+	if (transaction != NULL_PTR)
+	{
+		SPI_Transaction_Start(transaction);
+	}
+	else
+	{
+		SPI_DisableInterrupt();
+		SPI_Transaction_busy = FALSE;
+	}
+}
+
+uint8 SPI_SubmitTransaction(const SPI_TransactionType *a_transaction)
+{
+	uint8 sreg;
+
+	if (a_transaction->length == 0 || SPI_TransactionQueue_Push(*a_transaction) == FALSE)
+	{
+		return FALSE;
+	}
+
+	// start now if the bus is idle, otherwise the ISR starts it after the running one
+	sreg = SREG;
+	cli();
+	if (SPI_Transaction_busy == FALSE)
+	{
+		SPI_Transaction_busy = TRUE;
+		SPI_SetCallBack(SPI_Transaction_ISR);
+		SPI_Transaction_Start(SPI_TransactionQueue_Peek());
+		SPI_EnableInterrupt();
+	}
+	SREG = sreg;
+	return TRUE;
+}
+
+uint8 SPI_IsIdle(void)
+{
+	return (SPI_Transaction_busy == FALSE) ? TRUE : FALSE;
+}
+
+/**********************************************************************************************
+ * 										 	Slave engine									  *
+ **********************************************************************************************/
+/*************************** ISR for SPI Serial Transfer Complete (slave) ***************************/
+static void SPI_Slave_ISR(void)
+{
+	uint8 data = SPI_ReceiveByteNoBlock();
+
+	// preload the response first, the master may clock the next byte right away
+	SPI_SendByteNoBlock(SPI_Slave_nextTx);
+	if (IS_BIT_SET(SPSR, WCOL))
+	{
+		(void)SPI_ReceiveByteNoBlock(); // clear WCOL, this response is lost
+		SPI_Slave_errors++;
+	}
+
+	if (SPI_Slave_RxQueue_Push(data) == TRUE)
+	{
+		SPI_Slave_frameLength++;
+	}
+	else
+	{
+		SPI_Slave_errors++;
+	}
+
+	if (SPI_Slave_TxQueue_Pop(&SPI_Slave_nextTx) == FALSE)
+	{
+		SPI_Slave_nextTx = SPI_SLAVE_IDLE_BYTE;
+#if (SPI_SLAVE_DRDY == SPI_ENABLE)
+		GPIO_writePin(SPI_SLAVE_DRDY_PORT_ID, SPI_SLAVE_DRDY_PIN_ID, LOGIC_HIGH);
+#endif
+	}
+}
+
+/*************************** SS edge (EXTI call back) ***************************/
+static void SPI_Slave_SS_ISR(void)
+{
+	/* SS rising edge and the last byte may be pending together, the EXTI has the higher priority */
+	if (IS_BIT_SET(SPSR, SPIF))
+	{
+		SPI_Slave_ISR(); // reading SPSR then SPDR clears SPIF, the STC interrupt is cancelled
+	}
+
+#if (SPI_SLAVE_SS_INT == SPI_SLAVE_SS_INT2)
+	// wait for the opposite edge, the flag is cleared as changing ISC2 can set it
+	EXTI_disable(&SPI_Slave_SS_Config);
+	SPI_Slave_SS_Config.sense_control = (GPIO_readPin(PORTB_ID, PIN4_ID) == LOGIC_LOW) ? rising_edge : falling_edge;
+	EXTI_init(&SPI_Slave_SS_Config);
+	GIFR = BIT(SPI_SLAVE_SS_INTF);
+	EXTI_enable(&SPI_Slave_SS_Config);
+#endif
+
+	if (GPIO_readPin(PORTB_ID, PIN4_ID) == LOGIC_LOW)
+	{
+		SPI_Slave_frameLength = 0; // frame start
+	}
+	else if (SPI_Slave_frameLength != 0)
+	{
+		if (SPI_Slave_FrameQueue_Push(SPI_Slave_frameLength) == FALSE)
+		{
+			SPI_Slave_errors++; // the bytes stay in the RX queue for SPI_Slave_ReadByte
+		}
+		SPI_Slave_frameLength = 0;
+	}
+}
+
+void SPI_Slave_init(void)
+{
+	SPI_init(SPI_Slave, SPI_FOSC_4); // the clock rate is not used by the slave
+
+	SPI_Slave_nextTx = SPI_SLAVE_IDLE_BYTE;
+	SPI_Slave_frameLength = 0;
+	SPI_Slave_errors = 0;
+	SPI_SendByteNoBlock(SPI_SLAVE_IDLE_BYTE); // response to the first byte
+
+#if (SPI_SLAVE_DRDY == SPI_ENABLE)
+	GPIO_writePin(SPI_SLAVE_DRDY_PORT_ID, SPI_SLAVE_DRDY_PIN_ID, LOGIC_HIGH);
+	GPIO_setupPinDirection(SPI_SLAVE_DRDY_PORT_ID, SPI_SLAVE_DRDY_PIN_ID, PIN_OUTPUT);
+#endif
+
+	SPI_SetCallBack(SPI_Slave_ISR);
+	SPI_EnableInterrupt();
+
+	EXTI_init(&SPI_Slave_SS_Config);
+	EXTI_setCallBack(&SPI_Slave_SS_Config, SPI_Slave_SS_ISR);
+	GIFR = BIT(SPI_SLAVE_SS_INTF);
+	EXTI_enable(&SPI_Slave_SS_Config);
+}
+
+uint8 SPI_Slave_WriteByte(uint8 a_data)
+{
+#if (SPI_SLAVE_DRDY == SPI_ENABLE)
+	uint8 status;
+	uint8 sreg = SREG; // the ISR releases DRDY when it finds the queue empty
+	cli();
+	status = SPI_Slave_TxQueue_Push(a_data);
+	GPIO_writePin(SPI_SLAVE_DRDY_PORT_ID, SPI_SLAVE_DRDY_PIN_ID, LOGIC_LOW);
+	SREG = sreg;
+	return status;
+#else
+	return SPI_Slave_TxQueue_Push(a_data);
+#endif
+}
+
+uint8 SPI_Slave_ReadByte(uint8 *ptr_data)
+{
+	return SPI_Slave_RxQueue_Pop(ptr_data);
+}
+
+uint8 SPI_Slave_ReadFrame(uint8 *a_buffer, uint8 a_maxLength, uint8 *a_length)
+{
+	uint8 frameLength;
+	uint8 i;
+	uint8 data;
+
+	if (SPI_Slave_FrameQueue_Pop(&frameLength) == FALSE)
+	{
+		return FALSE;
+	}
+
+	*a_length = 0;
+	for (i = 0; i < frameLength; i++)
+	{
+		SPI_Slave_RxQueue_Pop(&data); // the bytes of a complete frame are already queued
+		if (i < a_maxLength)
+		{
+			a_buffer[i] = data;
+			(*a_length)++;
+		}
+	}
+	return TRUE;
+}
+
+uint8 SPI_Slave_GetTxFree(void)
+{
+	return SPI_Slave_TxQueue_Free();
+}
+
+uint16 SPI_Slave_GetErrorCount(void)
+{
+	uint16 errors;
+	uint8 sreg = SREG; // 16-bit counter updated from the ISRs
+	cli();
+	errors = SPI_Slave_errors;
+	SREG = sreg;
+	return errors;
+}
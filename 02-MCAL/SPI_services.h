@@ -16,12 +16,111 @@
 #include "SPI.h"
 #include "STD_TYPES.h"
 
-#define SPI_DEFAULT_DATA_VALUE 0xFF
+/* number of transactions that can wait for the SPI interrupt, power of two (<= 128) */
+#define SPI_TRANSACTION_QUEUE_SIZE 4
+
+/*******************************************************************************
+ *                    Module Data Types                                        *
+ * *****************************************************************************/
+/*
+ * One chip-select framed transfer clocked out by the SPI_STC_vect interrupt (master only).
+ * The buffers are used in place, they must stay valid until the call back.
+ */
+typedef struct
+{
+	const uint8 *txBuffer;		  // bytes to send, NULL_PTR -> send SPI_DEFAULT_DATA_VALUE
+	uint8 *rxBuffer;			  // received bytes, NULL_PTR -> discard them
+	uint8 length;				  // number of bytes (1 .. 255)
+	const SPI_DeviceType *device; // selected (settings and CS) for the whole transaction, see SPI_Device_init
+	void (*callBack)(void);		  // called from the ISR after CS is released, NULL_PTR for none
+} SPI_TransactionType;
 
 /*******************************************************************************
  *                    Functions Prototypes                                     *
  *******************************************************************************/
+/*
+ * Description : Send a null terminated string (without the '\0').
+ * Note        : use SPI_sendBlock for binary data
+ */
 void SPI_sendString(const uint8 *str);
+
+/*
+ * Description : Receive a string until the '#' symbol, the '#' is replaced by '\0'.
+ * Note        : the receiver has no bound on the buffer, use SPI_receiveBlock with a known length instead
+ */
 void SPI_receiveString(uint8 *str);
 
+/*
+ * Description : Queue a transaction to be clocked out from the SPI transfer complete interrupt.
+ * 				 Queued transactions run back-to-back in order, the CPU is free between the bytes.
+ * arguments   : const SPI_TransactionType *a_transaction : the descriptor is copied, not its buffers
+ * Return      : uint8 : status of the function [TRUE, FALSE (the queue is full or length = 0)]
+ * Note        : SPI_init(SPI_Master, ...) must be called and the global interrupts enabled,
+ * 				 the blocking SPI functions must not be used while a transaction is running.
+ */
+uint8 SPI_SubmitTransaction(const SPI_TransactionType *a_transaction);
+
+/*
+ * Description : Check if all the queued transactions are complete.
+ * arguments   : None
+ * Return      : uint8 : [TRUE (idle), FALSE (a transaction is running or queued)]
+ */
+uint8 SPI_IsIdle(void);
+
+/**************************************** Slave engine ***********************************************
+ * Every received byte is queued from the SPI_STC_vect interrupt and the next response byte (queued with
+ * SPI_Slave_WriteByte, or SPI_SLAVE_IDLE_BYTE) is written to SPDR right after the received one is read,
+ * so it is ready before the master clocks the next byte.
+ * SS edges (wired to SPI_SLAVE_SS_INT, see SPI_config.h) delimit the frames for SPI_Slave_ReadFrame.
+ * The master must leave a gap of at least SPI_SLAVE_BYTE_GAP_CYCLES slave CPU cycles between two bytes
+ * (and SPI_SLAVE_SS_GAP_CYCLES of SS high between two frames), see SPI_config.h: the response is written
+ * to SPDR by the interrupt after the byte ends, a back-to-back block (SPI_transferBlock) gives it only a
+ * few cycles, the response is then lost (WCOL, counted by SPI_Slave_GetErrorCount) and the master reads
+ * its own previous byte back from the shift register.
+ * It owns the SPI interrupt call back, so it can't be used with the transaction queue (master only anyway).
+ *****************************************************************************************************/
+
+/*
+ * Description : Initialize the SPI as slave with the interrupt driven RX/TX queues and the SS edge interrupt.
+ * arguments   : None
+ * Return      : None
+ * Note        : the global interrupts must be enabled
+ */
+void SPI_Slave_init(void);
+
+/*
+ * Description : Queue a response byte, it is sent in one of the next bytes clocked by the master.
+ * arguments   : uint8 a_data : response byte
+ * Return      : uint8 : status of the function [TRUE, FALSE (the TX buffer is full)]
+ * Note        : drives the data ready pin low (SPI_SLAVE_DRDY)
+ */
+uint8 SPI_Slave_WriteByte(uint8 a_data);
+
+/*
+ * Description : Get the oldest received byte.
+ * arguments   : uint8 *ptr_data : pointer to the variable to store the received data
+ * Return      : uint8 : status of the function [TRUE, FALSE (no data received)]
+ * Note        : use either SPI_Slave_ReadByte or SPI_Slave_ReadFrame
+ */
+uint8 SPI_Slave_ReadByte(uint8 *ptr_data);
+
+/*
+ * Description : Get the oldest complete frame (bytes received between SS falling and rising edges).
+ * arguments   : uint8 *a_buffer : buffer to store the frame
+ * 				 uint8 a_maxLength : size of the buffer, the rest of a longer frame is dropped
+ * 				 uint8 *a_length : pointer to the variable to store the number of bytes stored in a_buffer
+ * Return      : uint8 : status of the function [TRUE, FALSE (no complete frame)]
+ */
+uint8 SPI_Slave_ReadFrame(uint8 *a_buffer, uint8 a_maxLength, uint8 *a_length);
+
+/*
+ * Description : Number of free places in the response queue.
+ */
+uint8 SPI_Slave_GetTxFree(void);
+
+/*
+ * Description : Number of lost bytes: RX queue or frame queue full, or a response written too late (WCOL).
+ */
+uint16 SPI_Slave_GetErrorCount(void);
+
 #endif /* SPI_SERVICES_H_ */
\ No newline at end of file
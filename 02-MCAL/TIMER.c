@@ -14,9 +14,32 @@
 #include "TIMER.h"
 
 #include "BIT_MACROS.h"
+#include "SETTINGS.h" // for F_CPU
 #include <avr/interrupt.h>
 #include <avr/io.h>
 
+/******************************** Timer 2 tick prescaler (1 ms in CTC mode) ******************************/
+#if ((F_CPU / 8UL / 1000UL) <= 256UL)
+	#define TIMER2_TICK_PRESCALER 		8UL
+	#define TIMER2_TICK_CLOCK_SELECT 	2
+#elif ((F_CPU / 32UL / 1000UL) <= 256UL)
+	#define TIMER2_TICK_PRESCALER 		32UL
+	#define TIMER2_TICK_CLOCK_SELECT 	3
+#elif ((F_CPU / 64UL / 1000UL) <= 256UL)
+	#define TIMER2_TICK_PRESCALER 		64UL
+	#define TIMER2_TICK_CLOCK_SELECT 	4
+#elif ((F_CPU / 128UL / 1000UL) <= 256UL)
+	#define TIMER2_TICK_PRESCALER 		128UL
+	#define TIMER2_TICK_CLOCK_SELECT 	5
+#elif ((F_CPU / 256UL / 1000UL) <= 256UL)
+	#define TIMER2_TICK_PRESCALER 		256UL
+	#define TIMER2_TICK_CLOCK_SELECT 	6
+#else
+	#define TIMER2_TICK_PRESCALER 		1024UL
+	#define TIMER2_TICK_CLOCK_SELECT 	7
+#endif
+#define TIMER2_TICK_COMPARE_VALUE ((F_CPU / TIMER2_TICK_PRESCALER / 1000UL) - 1)
+
 /****************************Pointer to functions to be assigned to ISR*********************************/
 
 static void (*g_Timer1_OVF_callBackPtr)(void) = NULL_PTR;
@@ -26,6 +49,8 @@ static void (*g_Timer1_OCB_callBackPtr)(void) = NULL_PTR;
 static void (*g_Timer0_OVF_callBackPtr)(void) = NULL_PTR;
 static void (*g_Timer0_OC_callBackPtr)(void) = NULL_PTR;
 
+static volatile uint32 g_Timer2_tickMs = 0;
+
 /********************************************************************************************************
  * 												Timer 0													*
  ********************************************************************************************************/
@@ -317,4 +342,40 @@ void Timer1_OCA_SetCallBack(void (*LocalFptr)(void))
 void Timer1_OCB_SetCallBack(void (*LocalFptr)(void))
 {
 	g_Timer1_OCB_callBackPtr = LocalFptr;
-}
\ No newline at end of file
+}
+
+/********************************************************************************************************
+ * 										Timer 2 (System Tick)											*
+ ********************************************************************************************************/
+
+/********************************* Timer 2 ISR functions ****************************************************/
+ISR(TIMER2_COMP_vect)
+{
+	g_Timer2_tickMs++;
+}
+
+/********************************* Timer 2 initialization function ******************************************/
+void Timer2_Tick_init(void)
+{
+	/* CTC mode, OC2 disconnected */
+	TCCR2 = BIT(WGM21);
+	TCNT2 = 0;
+	OCR2 = (uint8)TIMER2_TICK_COMPARE_VALUE;
+
+	g_Timer2_tickMs = 0;
+	SET_BIT(TIMSK, OCIE2);
+
+	/* start the timer */
+	TCCR2 = (TCCR2 & 0xF8) | TIMER2_TICK_CLOCK_SELECT;
+}
+
+/*********************************************** Timer 2 Read ***********************************************/
+uint32 Timer2_Tick_getMs(void)
+{
+	uint32 ms;
+	uint8 sreg = SREG; // 32-bit read must not be split by the tick ISR
+	cli();
+	ms = g_Timer2_tickMs;
+	SREG = sreg;
+	return ms;
+}
@@ -79,12 +79,16 @@ void Timer0_init(const Timer0_ConfigType *Config_Ptr);
 //******************************** Write/Read ******************************************************
 void Timer0_WriteToTCNT0(uint8 a_value);
 uint8 Timer0_ReadTCNT0(void);
+void Timer0_WriteToOCR0(uint8 a_value);
 //******************************** overflow interrupt **********************************************
 void Timer0_OV_InterruptEnable(void);
 void Timer0_OV_InterruptDisable(void);
 //******************************** Output Compare interrupt ****************************************
 void Timer0_OC_InterruptEnable(void);
 void Timer0_OC_InterruptDisable(void);
+//******************************** Call Back Functions *********************************************
+void Timer0_OVF_SetCallBack(void (*LocalFptr)(void));
+void Timer0_Oc_SetCallBack(void (*LocalFptr)(void));
 
 /********************************************************************************************************
  * 												Timer 1													*
@@ -173,4 +177,23 @@ void Timer1_OVF_SetCallBack(void (*LocalFptr)(void));
 void Timer1_OCA_SetCallBack(void (*LocalFptr)(void));
 void Timer1_OCB_SetCallBack(void (*LocalFptr)(void));
 
+/********************************************************************************************************
+ * 										Timer 2 (System Tick)											*
+ ********************************************************************************************************/
+/*
+ * Timer2 runs in CTC mode and interrupts every 1 ms, the prescaler and OCR2 are selected
+ * at compile time from F_CPU. The tick is shared by every driver that needs a timeout,
+ * so they don't rely on calibrated busy loops. Global interrupts must be enabled.
+ */
+
+//******************************** Initialization **************************************************
+void Timer2_Tick_init(void);
+
+//******************************** Read *************************************************************
+/*******************************************************************************
+ * Description: Get the number of milliseconds since Timer2_Tick_init (wraps after 49 days)
+ * @return uint32 milliseconds
+ *******************************************************************************/
+uint32 Timer2_Tick_getMs(void);
+
 #endif /* TIMER_H_ */
\ No newline at end of file
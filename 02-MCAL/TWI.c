@@ -14,27 +14,68 @@
 
 #include "BIT_MACROS.h"
 #include "SETTINGS.h" /* For F_CPU */
+#include <avr/interrupt.h>
 #include <avr/io.h>
+#include <util/delay.h>
 
-// Calculate the TWBR value for a given SCL frequency and prescaler value
-#define TWBR_VALUE(SCL_freq, TWPS_value) ((F_CPU / SCL_freq) - 16) / (2 * (1 << TWPS_value))
+/* device whose bit rate is in TWBR/TWSR, NULL_PTR after TWI_init */
+static const TWI_DeviceType *TWI_activeDevice = NULL_PTR;
+
+/* Global pointer to the function called from the TWI interrupt */
+static void (*TWI_callBackPtr)(void) = NULL_PTR;
+
+/* TRUE when the last wait for TWINT gave up, reported by TWI_getStatus */
+static uint8 TWI_timedOut = FALSE;
+
+/**
+ * @brief Wait for TWINT, at most TWI_TIMEOUT_US.
+ *
+ * On timeout the TWI is disabled (it releases SCL and SDA) and TWI_getStatus returns TWI_TIMEOUT,
+ * the next START enables it again.
+ */
+static void TWI_waitForFlag(void)
+{
+	uint16 loops = (uint16)TWI_TIMEOUT_LOOPS;
+
+	TWI_timedOut = FALSE;
+	while (IS_BIT_CLEAR(TWCR, TWINT))
+	{
+		if (--loops == 0)
+		{
+			TWCR = 0;
+			TWI_timedOut = TRUE;
+			return;
+		}
+	}
+}
 
 /**
  * @brief Initialize the TWI (I2C) module based on the provided configuration.
  *
  * This function initializes the TWI module based on the configuration provided
- * through the \c Config_Ptr parameter. It sets the TWBR value, prescaler,
- * slave address, and enables the TWI module.
+ * through the \c Config_Ptr parameter. It sets the TWBR value for the SCL frequency
+ * with the given prescaler, the slave address, and enables the TWI module.
  *
  * @param Config_Ptr A pointer to the configuration structure.
  */
 void TWI_init(const TWI_configType *Config_Ptr)
 {
+	uint32 twbr = TWI_TWBR_RAW((uint32)Config_Ptr->SCL_Frq, Config_Ptr->prescaler);
+
 	//***************************** Bit Rate *************************
-	TWBR_VALUE(Config_Ptr->SCL_Frq, Config_Ptr->prescaler);
+	if (twbr < TWI_TWBR_MIN)
+	{
+		twbr = TWI_TWBR_MIN; // highest rate of this F_CPU
+	}
+	else if (twbr > 255)
+	{
+		twbr = 255; // a bigger prescaler is needed for this rate
+	}
+	TWBR = (uint8)twbr;
 
 	//***************************** Prescaler *************************
 	TWSR = Config_Ptr->prescaler;
+	TWI_activeDevice = NULL_PTR;
 
 	//**************** Configure Slave Address and General Call Recognition Mode ***************
 	TWAR = ((Config_Ptr->TWI_slaveAddress) << 1);
@@ -63,21 +104,23 @@ void TWI_start(void)
 	 * - Enable TWI Module (TWEN)
 	 */
 	// SET_MASK(TWCR, BIT(TWSTA) | BIT(TWINT) | BIT(TWEN));
+	TWI_timedOut = FALSE; // a timeout of the previous operation (or of its STOP) is over
 	TWCR = BIT(TWINT) | BIT(TWEN) | BIT(TWSTA);
 
 	/* Wait for TWINT flag set in TWCR Register (start bit is send successfully) */
-	while (IS_BIT_CLEAR(TWCR, TWINT))
-		;
+	TWI_waitForFlag();
 }
 
 /**
  * @brief Stop the TWI communication.
  *
  * This function generates a stop condition on the TWI bus. It waits until the
- * stop bit is sent successfully before returning.
+ * stop bit is sent successfully before returning (TWSTO cleared), so a START can follow it,
+ * at most TWI_TIMEOUT_US: then the TWI is disabled like in TWI_waitForFlag.
  */
 void TWI_stop(void)
 {
+	uint16 loops = (uint16)TWI_TIMEOUT_LOOPS;
 
 	/*
 	 * - Enable the stop bit (TWSTO)
@@ -87,6 +130,16 @@ void TWI_stop(void)
 	// SET_MASK(TWCR, BIT(TWSTO) | BIT(TWINT) | BIT(TWEN));
 
 	TWCR = BIT(TWINT) | BIT(TWEN) | BIT(TWSTO);
+
+	while (IS_BIT_SET(TWCR, TWSTO))
+	{
+		if (--loops == 0)
+		{
+			TWCR = 0; // SCL held low by a slave: release the pins, the next START enables the TWI again
+			TWI_timedOut = TRUE;
+			return;
+		}
+	}
 }
 
 /**
@@ -110,8 +163,7 @@ void TWI_writeByte(uint8 data)
 	TWCR = BIT(TWINT) | BIT(TWEN);
 
 	/* Wait for data is send successfully */
-	while (IS_BIT_CLEAR(TWCR, TWINT))
-		;
+	TWI_waitForFlag();
 }
 
 /**
@@ -133,8 +185,7 @@ uint8 TWI_readByteWithACK(void)
 	TWCR = BIT(TWINT) | BIT(TWEN) | BIT(TWEA);
 
 	/* Wait for TWINT flag set in TWCR Register (data received successfully) */
-	while (IS_BIT_CLEAR(TWCR, TWINT))
-		;
+	TWI_waitForFlag();
 
 	/* Read Data */
 	return TWDR;
@@ -158,8 +209,7 @@ uint8 TWI_readByteWithNACK(void)
 	TWCR = BIT(TWINT) | BIT(TWEN);
 
 	/* Wait for TWINT flag set in TWCR Register (data received successfully) */
-	while (IS_BIT_CLEAR(TWCR, TWINT))
-		;
+	TWI_waitForFlag();
 
 	/* Read Data */
 	return TWDR;
@@ -176,7 +226,107 @@ uint8 TWI_readByteWithNACK(void)
 uint8 TWI_getStatus(void)
 {
 	uint8 status;
+
+	if (TWI_timedOut == TRUE)
+	{
+		return TWI_TIMEOUT;
+	}
 	/* masking to eliminate first 3 bits and get the last 5 bits (status bits) */
 	status = TWSR & 0xF8;
 	return status;
 }
+
+/**
+ * @brief Release a bus held by a slave.
+ *
+ * A slave reset in the middle of a read keeps SDA low until it has clocked out its byte, the TWI
+ * then can't send START or STOP. The TWI is disabled, SCL is clocked up to 9 times as an open drain
+ * GPIO until SDA is released, then a STOP is generated and the TWI is enabled again.
+ * Takes at most 110 us (TWI_RECOVERY_HALF_PERIOD_US = 5).
+ *
+ * @return TRUE if SCL and SDA are both high afterwards, FALSE if the bus is still held.
+ */
+uint8 TWI_recoverBus(void)
+{
+	uint8 portc = PORTC & (BIT(TWI_SCL_PIN) | BIT(TWI_SDA_PIN));
+	uint8 released;
+	uint8 i;
+
+	TWCR = 0; // the pins go back to the GPIO
+
+	/* open drain: low = output 0, high = input (external pull up) */
+	PORTC &= ~(BIT(TWI_SCL_PIN) | BIT(TWI_SDA_PIN));
+	DDRC &= ~(BIT(TWI_SCL_PIN) | BIT(TWI_SDA_PIN));
+	_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+
+	for (i = 0; i < 9 && IS_BIT_CLEAR(PINC, TWI_SDA_PIN); i++)
+	{
+		SET_BIT(DDRC, TWI_SCL_PIN);
+		_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+		CLEAR_BIT(DDRC, TWI_SCL_PIN);
+		_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+	}
+
+	/* STOP: SDA rises while SCL is high */
+	SET_BIT(DDRC, TWI_SCL_PIN);
+	_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+	SET_BIT(DDRC, TWI_SDA_PIN);
+	_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+	CLEAR_BIT(DDRC, TWI_SCL_PIN);
+	_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+	CLEAR_BIT(DDRC, TWI_SDA_PIN);
+	_delay_us(TWI_RECOVERY_HALF_PERIOD_US);
+
+	released = (IS_BIT_SET(PINC, TWI_SCL_PIN) && IS_BIT_SET(PINC, TWI_SDA_PIN)) ? TRUE : FALSE;
+
+	PORTC |= portc; // pull ups of the application
+	TWI_timedOut = FALSE;
+	TWCR = BIT(TWEN);
+
+	return released;
+}
+
+/**
+ * @brief Switch the bus to the bit rate of a device.
+ *
+ * TWBR and TWPS are written only if another device (or TWI_init) set them last,
+ * so consecutive accesses to the same device cost one comparison.
+ *
+ * @param a_device The device to talk to, see TWI_DEVICE.
+ */
+void TWI_select(const TWI_DeviceType *a_device)
+{
+	if (a_device != TWI_activeDevice)
+	{
+		TWBR = a_device->twbr;
+		TWSR = a_device->twps; // only TWPS is writable
+		TWI_activeDevice = a_device;
+	}
+}
+
+/**
+ * @brief Set the function called from the TWI interrupt (TWINT set while TWIE is enabled).
+ *
+ * The call back handles the bus state (TWSR) and must write TWCR to clear TWINT.
+ *
+ * @param LocalFptr The function to call, NULL_PTR to turn TWIE off on the next interrupt
+ *                  (TWINT is left set).
+ */
+void TWI_SetCallBack(void (*LocalFptr)(void))
+{
+	TWI_callBackPtr = LocalFptr;
+}
+
+ISR(TWI_vect)
+{
+	if (TWI_callBackPtr != NULL_PTR)
+	{
+		TWI_callBackPtr();
+	}
+	else
+	{
+		/* nobody handles the bus: only turn TWIE off, writing 0 to TWINT leaves it set
+		 * so the bus stays held in its current state for the next polling user */
+		TWCR &= ~(BIT(TWIE) | BIT(TWINT));
+	}
+}
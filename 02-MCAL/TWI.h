@@ -13,6 +13,7 @@
 #ifndef TWI_H_
 #define TWI_H_
 
+#include "SETTINGS.h" /* For F_CPU */
 #include "STD_TYPES.h"
 
 /*******************************************************************************
@@ -27,6 +28,76 @@
 #define TWI_MT_DATA_ACK 0x28  /* Master transmit data and ACK has been received from Slave. */
 #define TWI_MR_DATA_ACK 0x50  /* Master received data and send ACK to slave. */
 #define TWI_MR_DATA_NACK 0x58 /* Master received data but doesn't send ACK to slave. */
+#define TWI_MT_SLA_W_NACK 0x20 /* Master transmit ( slave address + Write request ) to slave + NACK received (no slave). */
+#define TWI_MT_DATA_NACK 0x30  /* Master transmit data and NACK has been received from Slave. */
+#define TWI_ARB_LOST 0x38	   /* Arbitration lost to another master. */
+#define TWI_MR_SLA_R_NACK 0x48 /* Master transmit ( slave address + Read request ) to slave + NACK received (no slave). */
+#define TWI_BUS_ERROR 0x00	   /* Illegal START or STOP condition on the bus. */
+#define TWI_TIMEOUT 0x01		   /* (driver) TWINT not set within TWI_TIMEOUT_US, the TWI is disabled until the next START. */
+
+/* Slave mode status */
+#define TWI_SR_SLA_ACK 0x60		   /* Own SLA+W received, ACK returned. */
+#define TWI_SR_ARB_LOST_SLA_ACK 0x68 /* Arbitration lost as master, own SLA+W received. */
+#define TWI_SR_GCALL_ACK 0x70	   /* General call received, ACK returned. */
+#define TWI_SR_ARB_LOST_GCALL_ACK 0x78 /* Arbitration lost as master, general call received. */
+#define TWI_SR_DATA_ACK 0x80	   /* Addressed with own SLA+W, data received, ACK returned. */
+#define TWI_SR_DATA_NACK 0x88	   /* Addressed with own SLA+W, data received, NACK returned. */
+#define TWI_SR_GCALL_DATA_ACK 0x90 /* Addressed with general call, data received, ACK returned. */
+#define TWI_SR_GCALL_DATA_NACK 0x98 /* Addressed with general call, data received, NACK returned. */
+#define TWI_SR_STOP 0xA0		   /* STOP or repeated START received while addressed. */
+#define TWI_ST_SLA_ACK 0xA8		   /* Own SLA+R received, ACK returned. */
+#define TWI_ST_ARB_LOST_SLA_ACK 0xB0 /* Arbitration lost as master, own SLA+R received. */
+#define TWI_ST_DATA_ACK 0xB8	   /* Data transmitted, ACK received. */
+#define TWI_ST_DATA_NACK 0xC0	   /* Data transmitted, NACK received (end of the master read). */
+#define TWI_ST_LAST_DATA 0xC8	   /* Last data transmitted (TWEA = 0), ACK received. */
+
+/*
+ * Bit rate: SCL = F_CPU / (16 + 2 * TWBR * 4^TWPS)
+ * The smallest prescaler that fits TWBR in 8 bits is used, and TWBR is at least TWI_TWBR_MIN
+ * (datasheet minimum in master mode), so the highest SCL is F_CPU / 36: 222 kHz at 8 MHz,
+ * 400 kHz needs F_CPU >= 14.4 MHz. All constant arguments are evaluated by the compiler.
+ */
+#define TWI_TWBR_MIN 10UL
+#define TWI_TWBR_RAW(SCL_freq, TWPS_value) \
+	(((F_CPU) / (SCL_freq) > 16UL) ? (((F_CPU) / (SCL_freq)) - 16UL) / (2UL << (2 * (TWPS_value))) : 0UL)
+#define TWI_TWPS_VALUE(SCL_freq)                         \
+	((TWI_TWBR_RAW(SCL_freq, 0) <= 255UL)   ? 0          \
+	 : (TWI_TWBR_RAW(SCL_freq, 1) <= 255UL) ? 1          \
+	 : (TWI_TWBR_RAW(SCL_freq, 2) <= 255UL) ? 2          \
+											: 3)
+#define TWI_TWBR_VALUE(SCL_freq)                                                 \
+	((TWI_TWBR_RAW(SCL_freq, TWI_TWPS_VALUE(SCL_freq)) < TWI_TWBR_MIN) ? TWI_TWBR_MIN \
+	 : (TWI_TWBR_RAW(SCL_freq, TWI_TWPS_VALUE(SCL_freq)) > 255UL)	   ? 255UL        \
+																	   : TWI_TWBR_RAW(SCL_freq, TWI_TWPS_VALUE(SCL_freq)))
+
+/* Static initializer of a TWI_DeviceType: TWI_DeviceType EEPROM_Device = TWI_DEVICE(0x50, FastMode_400Kb); */
+#define TWI_DEVICE(address, SCL_freq) {(address), (uint8)TWI_TWBR_VALUE(SCL_freq), (uint8)TWI_TWPS_VALUE(SCL_freq)}
+
+/*************************************** Bus timeout ***************************************************
+ * Every wait for TWINT gives up after TWI_TIMEOUT_US, TWI_getStatus then returns TWI_TIMEOUT
+ * and TWI_recoverBus releases a slave that holds SDA low (9 SCL clocks + STOP).
+ * The longest normal wait is one byte + ACK (9 SCL periods, 90 us at 100 kHz) plus the clock
+ * stretching of the slaves, so the timeout must stay above it.
+ *
+ * Worst case latency of any blocking TWI operation (EEPROM_xxx):
+ * 	normal bus time + TWI_TIMEOUT_US (one wait, the operation stops at the first error)
+ * 	+ TWI_recoverBus (at most 9 clocks + STOP: 11 * 2 * TWI_RECOVERY_HALF_PERIOD_US = 110 us)
+ * 	e.g. EEPROM_readPage of 16 bytes at 100 kHz: 1.9 ms + 1 ms + 0.11 ms = 3 ms.
+ *****************************************************************************************************/
+#define TWI_TIMEOUT_US 					1000UL
+#define TWI_RECOVERY_HALF_PERIOD_US 	5 /* 100 kHz SCL while recovering */
+
+/* SCL and SDA pins, driven as GPIO by TWI_recoverBus */
+#define TWI_SCL_PIN 					PC0
+#define TWI_SDA_PIN 					PC1
+
+/* the wait loop (TWCR read, test, counter decrement, branch) takes about 8 cycles */
+#define TWI_WAIT_LOOP_CYCLES 			8UL
+#define TWI_TIMEOUT_LOOPS 				((F_CPU) / 1000000UL * (TWI_TIMEOUT_US) / TWI_WAIT_LOOP_CYCLES)
+
+#if (TWI_TIMEOUT_LOOPS > 65535UL) || (TWI_TIMEOUT_LOOPS == 0)
+#error "TWI_TIMEOUT_US doesn't fit the 16-bit wait counter at this F_CPU"
+#endif
 
 /*******************************************************************************
  *                         Types Declaration                                   *
@@ -62,6 +133,17 @@ typedef struct
 	uint8 TWI_slaveAddress;
 } TWI_configType;
 
+/*
+ * A slave on the bus with its own bit rate, every access goes through TWI_select which reprograms
+ * TWBR/TWPS only when the selected device is not the one of the last access.
+ */
+typedef struct
+{
+	uint8 address; // 7-bit slave address
+	uint8 twbr;	   // bit rate register images, see TWI_DEVICE
+	uint8 twps;
+} TWI_DeviceType;
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -72,6 +154,13 @@ void TWI_stop(void);
 void TWI_writeByte(uint8 data);
 uint8 TWI_readByteWithACK(void);  // read with send Ack
 uint8 TWI_readByteWithNACK(void); // read without send Ack
-uint8 TWI_getStatus(void);
+uint8 TWI_getStatus(void);		  // TWSR status of the last operation, or TWI_TIMEOUT
+uint8 TWI_recoverBus(void);		  // TRUE if SDA and SCL are released (high) afterwards
+
+/****************************************** Multi-device bus ************************************************/
+void TWI_select(const TWI_DeviceType *a_device); // the bus must be idle (no START sent)
+
+/***************************************** Call Back Function ***********************************************/
+void TWI_SetCallBack(void (*LocalFptr)(void));
 
 #endif /* TWI_H_ */
@@ -0,0 +1,411 @@
+/******************************************************************************
+ *
+ * Module: TWI (I2C)
+ *
+ * File Name: TWI_services.c
+ *
+ * Description: Source file for the TWI Services driver
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+
+#include "TWI_services.h"
+
+#include "BIT_MACROS.h"
+#include "QUEUE.h"
+#include "TIMER.h" // for the system tick
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+#define TWI_WRITE 0
+#define TWI_READ  1
+
+/* TWCR values of the interrupt driven steps (writing TWINT clears it and starts the step) */
+#define TWI_CONTINUE 		(BIT(TWINT) | BIT(TWEN) | BIT(TWIE))
+#define TWI_CONTINUE_ACK 	(BIT(TWINT) | BIT(TWEN) | BIT(TWIE) | BIT(TWEA))
+#define TWI_SEND_START 		(BIT(TWINT) | BIT(TWEN) | BIT(TWIE) | BIT(TWSTA))
+#define TWI_SEND_STOP 		(BIT(TWINT) | BIT(TWEN) | BIT(TWSTO))
+
+/*
+ * status of the bus in the ISRs: TWSR itself, not TWI_getStatus which reports the timeout
+ * of the last blocking call (TWI_TIMEOUT) until the next blocking START
+ */
+#define TWI_ISR_STATUS() 	(TWSR & 0xF8)
+
+/* produced by TWI_SubmitTransaction, consumed by the TWI_vect call back */
+QUEUE_DEFINE(TWI_TransactionQueue, TWI_TransactionType, TWI_TRANSACTION_QUEUE_SIZE)
+
+static volatile boolean TWI_Transaction_busy = FALSE;
+static uint8 TWI_Transaction_txIndex = 0; // ISR only
+static uint8 TWI_Transaction_rxIndex = 0;
+static uint32 TWI_Transaction_startMs = 0; // system tick at the START of the running transaction
+
+/*************************** Slave engine ***************************/
+#define TWI_SLAVE_ACK 		(BIT(TWINT) | BIT(TWEN) | BIT(TWIE) | BIT(TWEA))
+
+static const TWI_Slave_RegisterMapType *TWI_Slave_map = NULL_PTR;
+static uint8 TWI_Slave_pointer = 0;				  // register of the next access
+static volatile boolean TWI_Slave_busy = FALSE;	  // addressed by the master (until STOP / NACK)
+static boolean TWI_Slave_pointerReceived = FALSE; // the first byte of a write is the pointer
+static uint8 TWI_Slave_writeFirst = 0;			  // registers changed by the running write
+static uint8 TWI_Slave_writeCount = 0;
+
+/**********************************************************************************************
+ * 										 	Transaction queue								  *
+ **********************************************************************************************/
+static void TWI_Transaction_Start(void)
+{
+	TWI_select(TWI_TransactionQueue_Peek()->device); // the bus is idle, after the STOP of the previous one
+	TWI_Transaction_txIndex = 0;
+	TWI_Transaction_rxIndex = 0;
+	TWI_Transaction_startMs = Timer2_Tick_getMs();
+	TWCR = TWI_SEND_START;
+}
+
+/* ACK the next received byte unless it is the last one */
+static void TWI_Transaction_Receive(const volatile TWI_TransactionType *a_transaction)
+{
+	TWCR = (TWI_Transaction_rxIndex + 1 < a_transaction->rxLength) ? TWI_CONTINUE_ACK : TWI_CONTINUE;
+}
+
+/* report the result of the running transaction then start the next one */
+static void TWI_Transaction_Finish(TWI_ResultType a_result)
+{
+	const volatile TWI_TransactionType *transaction = TWI_TransactionQueue_Peek();
+	void (*callBack)(TWI_ResultType);
+
+	if (transaction->result != NULL_PTR)
+	{
+		*transaction->result = a_result;
+	}
+	callBack = transaction->callBack;
+	TWI_TransactionQueue_Drop(); // the descriptor can be reused from now on
+
+	if (callBack != NULL_PTR)
+	{
+		callBack(a_result);
+	}
+
+	if (TWI_TransactionQueue_Count() != 0)
+	{
+		TWI_Transaction_Start();
+	}
+	else
+	{
+		TWI_Transaction_busy = FALSE;
+	}
+}
+
+/* STOP (not after a lost arbitration, the bus belongs to the other master) then start the next one */
+static void TWI_Transaction_End(TWI_ResultType a_result)
+{
+	uint16 loops = (uint16)TWI_TIMEOUT_LOOPS;
+
+	if (a_result == TWI_RESULT_ARB_LOST)
+	{
+		TWCR = BIT(TWINT) | BIT(TWEN); // back to the not addressed slave mode
+	}
+	else
+	{
+		TWCR = TWI_SEND_STOP;
+		while (IS_BIT_SET(TWCR, TWSTO) && --loops != 0) // the STOP takes a few us, a START can't be requested before
+			;
+		if (loops == 0)
+		{
+			TWCR = 0; // SCL held low by a slave: release the pins, the next START enables the TWI again
+		}
+	}
+
+	TWI_Transaction_Finish(a_result);
+}
+
+/*************************** ISR for TWI (TWINT) ***************************/
+static void TWI_Transaction_ISR(void)
+{
+	const volatile TWI_TransactionType *transaction = TWI_TransactionQueue_Peek();
+
+	if (transaction == NULL_PTR)
+	{
+		TWCR = BIT(TWINT) | BIT(TWEN); // not started by the queue
+		return;
+	}
+
+	switch (TWI_ISR_STATUS())
+	{
+	case TWI_START:
+	case TWI_REP_START:
+		/* the write phase comes first, a read only transaction goes straight to SLA+R */
+		if (TWI_Transaction_txIndex == 0 && (transaction->txLength != 0 || transaction->rxLength == 0))
+		{
+			TWDR = (uint8)(transaction->device->address << 1) | TWI_WRITE;
+		}
+		else
+		{
+			TWDR = (uint8)(transaction->device->address << 1) | TWI_READ;
+		}
+		TWCR = TWI_CONTINUE;
+		break;
+
+	case TWI_MT_SLA_W_ACK:
+	case TWI_MT_DATA_ACK:
+		if (TWI_Transaction_txIndex < transaction->txLength)
+		{
+			TWDR = transaction->txBuffer[TWI_Transaction_txIndex++];
+			TWCR = TWI_CONTINUE;
+		}
+		else if (transaction->rxLength != 0)
+		{
+			TWI_Transaction_txIndex = 0xFF; // write phase done, the repeated start sends SLA+R
+			TWCR = TWI_SEND_START;
+		}
+		else
+		{
+			TWI_Transaction_End(TWI_RESULT_OK);
+		}
+		break;
+
+	case TWI_MT_SLA_R_ACK:
+		TWI_Transaction_Receive(transaction);
+		break;
+
+	case TWI_MR_DATA_ACK:
+		transaction->rxBuffer[TWI_Transaction_rxIndex++] = TWDR;
+		TWI_Transaction_Receive(transaction);
+		break;
+
+	case TWI_MR_DATA_NACK: // last byte
+		transaction->rxBuffer[TWI_Transaction_rxIndex++] = TWDR;
+		TWI_Transaction_End(TWI_RESULT_OK);
+		break;
+
+	case TWI_MT_SLA_W_NACK:
+	case TWI_MT_DATA_NACK:
+	case TWI_MR_SLA_R_NACK:
+		TWI_Transaction_End(TWI_RESULT_NACK);
+		break;
+
+	case TWI_ARB_LOST:
+		TWI_Transaction_End(TWI_RESULT_ARB_LOST);
+		break;
+
+	default: // TWI_BUS_ERROR
+		TWI_Transaction_End(TWI_RESULT_BUS_ERROR);
+		break;
+	}
+}
+
+uint8 TWI_SubmitTransaction(const TWI_TransactionType *a_transaction)
+{
+	uint8 sreg;
+
+	if (a_transaction->result != NULL_PTR)
+	{
+		*a_transaction->result = TWI_RESULT_PENDING;
+	}
+	if (TWI_TransactionQueue_Push(*a_transaction) == FALSE)
+	{
+		return FALSE;
+	}
+
+	// start now if the bus is idle, otherwise the ISR starts it after the running one
+	sreg = SREG;
+	cli();
+	if (TWI_Transaction_busy == FALSE)
+	{
+		TWI_Transaction_busy = TRUE;
+		TWI_SetCallBack(TWI_Transaction_ISR);
+		TWI_Transaction_Start();
+	}
+	SREG = sreg;
+	return TRUE;
+}
+
+uint8 TWI_IsIdle(void)
+{
+	uint8 sreg;
+
+	sreg = SREG;
+	cli();
+	/* watchdog: no TWINT for too long (SCL stretched forever, TWI stopped), the ISR won't end it */
+	if (TWI_Transaction_busy == TRUE && Timer2_Tick_getMs() - TWI_Transaction_startMs > TWI_TRANSACTION_TIMEOUT_MS)
+	{
+		TWI_recoverBus(); // also leaves the TWI enabled with its interrupt off
+		TWI_Transaction_Finish(TWI_RESULT_TIMEOUT);
+	}
+	SREG = sreg;
+
+	return (TWI_Transaction_busy == FALSE) ? TRUE : FALSE;
+}
+
+/**********************************************************************************************
+ * 										 	Bus enumeration									  *
+ **********************************************************************************************/
+uint8 TWI_Probe(const TWI_DeviceType *a_device)
+{
+	uint8 status;
+
+	TWI_select(a_device);
+	TWI_start();
+	status = TWI_getStatus();
+	if (status == TWI_START)
+	{
+		TWI_writeByte((uint8)(a_device->address << 1) | TWI_WRITE);
+		status = TWI_getStatus();
+	}
+
+	if (status == TWI_TIMEOUT)
+	{
+		TWI_recoverBus(); // a held bus doesn't stop the scan
+	}
+	else if (status != TWI_ARB_LOST)
+	{
+		TWI_stop();
+	}
+	return (status == TWI_MT_SLA_W_ACK) ? TRUE : FALSE;
+}
+
+uint8 TWI_ScanBus(uint8 *a_addresses, uint8 a_maxCount)
+{
+	/* the pointer is what TWI_select compares, changing the address keeps the bit rate */
+	static TWI_DeviceType scanDevice = TWI_DEVICE(TWI_SCAN_FIRST_ADDRESS, NormalMode_100Kb);
+	uint8 count = 0;
+	uint8 address;
+
+	for (address = TWI_SCAN_FIRST_ADDRESS; address <= TWI_SCAN_LAST_ADDRESS && count < a_maxCount; address++)
+	{
+		scanDevice.address = address;
+		if (TWI_Probe(&scanDevice) == TRUE)
+		{
+			a_addresses[count++] = address;
+		}
+	}
+	return count;
+}
+
+/**********************************************************************************************
+ * 										 	Slave engine									  *
+ **********************************************************************************************/
+/* end of a master write: report the changed registers */
+static void TWI_Slave_EndWrite(void)
+{
+	if (TWI_Slave_writeCount != 0 && TWI_Slave_map->writeCallBack != NULL_PTR)
+	{
+		TWI_Slave_map->writeCallBack(TWI_Slave_writeFirst, TWI_Slave_writeCount);
+	}
+	TWI_Slave_writeCount = 0;
+}
+
+static uint8 TWI_Slave_NextByte(void)
+{
+	uint8 data = 0xFF;
+
+	if (TWI_Slave_pointer < TWI_Slave_map->size)
+	{
+		data = TWI_Slave_map->registers[TWI_Slave_pointer++];
+	}
+	return data;
+}
+
+/*************************** ISR for TWI (slave) ***************************/
+static void TWI_Slave_ISR(void)
+{
+	uint8 data;
+
+	switch (TWI_ISR_STATUS())
+	{
+	/********************** master write **********************/
+	case TWI_SR_SLA_ACK:
+	case TWI_SR_ARB_LOST_SLA_ACK:
+	case TWI_SR_GCALL_ACK:
+	case TWI_SR_ARB_LOST_GCALL_ACK:
+		TWI_Slave_busy = TRUE;
+		TWI_Slave_pointerReceived = FALSE;
+		TWI_Slave_writeCount = 0;
+		break;
+
+	case TWI_SR_DATA_ACK:
+	case TWI_SR_GCALL_DATA_ACK:
+		data = TWDR;
+		if (TWI_Slave_pointerReceived == FALSE)
+		{
+			TWI_Slave_pointer = data;
+			TWI_Slave_pointerReceived = TRUE;
+		}
+		else
+		{
+			if (TWI_Slave_pointer >= TWI_Slave_map->writableFirst && TWI_Slave_pointer < TWI_Slave_map->size)
+			{
+				TWI_Slave_map->registers[TWI_Slave_pointer] = data;
+				if (TWI_Slave_writeCount == 0)
+				{
+					TWI_Slave_writeFirst = TWI_Slave_pointer;
+				}
+				TWI_Slave_writeCount++;
+			}
+			TWI_Slave_pointer++; // read-only registers are skipped
+		}
+		break;
+
+	case TWI_SR_STOP: // STOP, or repeated START before a read from the pointer
+		TWI_Slave_EndWrite();
+		TWI_Slave_busy = FALSE;
+		break;
+
+	/********************** master read ***********************/
+	case TWI_ST_SLA_ACK:
+	case TWI_ST_ARB_LOST_SLA_ACK:
+		TWI_Slave_busy = TRUE;
+		/* fall through */
+	case TWI_ST_DATA_ACK:
+		TWDR = TWI_Slave_NextByte();
+		break;
+
+	case TWI_ST_DATA_NACK:
+	case TWI_ST_LAST_DATA:
+	case TWI_SR_DATA_NACK:
+	case TWI_SR_GCALL_DATA_NACK:
+		TWI_Slave_busy = FALSE;
+		break;
+
+	default: // TWI_BUS_ERROR: release the lines, no STOP is sent on the bus
+		TWI_Slave_busy = FALSE;
+		TWCR = TWI_SLAVE_ACK | BIT(TWSTO);
+		return;
+	}
+
+	TWCR = TWI_SLAVE_ACK; // keep answering to the own address
+}
+
+void TWI_Slave_init(uint8 a_address, const TWI_Slave_RegisterMapType *a_map)
+{
+	TWI_Slave_map = a_map;
+	TWI_Slave_pointer = 0;
+	TWI_Slave_busy = FALSE;
+	TWI_Slave_writeCount = 0;
+
+	TWAR = (uint8)(a_address << 1) | (TWAR & BIT(TWGCE)); // keep the general call setting of TWI_init
+	TWI_SetCallBack(TWI_Slave_ISR);
+	TWCR = TWI_SLAVE_ACK;
+}
+
+uint8 TWI_Slave_WriteRegisters(uint8 a_first, const uint8 *a_data, uint8 a_count)
+{
+	uint8 sreg;
+	uint8 i;
+
+	sreg = SREG;
+	cli();
+	if (TWI_Slave_busy == TRUE)
+	{
+		SREG = sreg;
+		return FALSE;
+	}
+	for (i = 0; i < a_count && (uint8)(a_first + i) < TWI_Slave_map->size; i++)
+	{
+		TWI_Slave_map->registers[a_first + i] = a_data[i];
+	}
+	SREG = sreg;
+	return TRUE;
+}
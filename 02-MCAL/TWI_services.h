@@ -0,0 +1,147 @@
+/******************************************************************************
+ *
+ * Module: TWI (I2C)
+ *
+ * File Name: TWI_services.h
+ *
+ * Description: Header file for the TWI Services driver
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+
+#ifndef TWI_SERVICES_H_
+#define TWI_SERVICES_H_
+
+#include "STD_TYPES.h"
+#include "TWI.h"
+
+/* number of transactions that can wait for the TWI interrupt, power of two (<= 128) */
+#define TWI_TRANSACTION_QUEUE_SIZE 4
+
+/*
+ * A running transaction is aborted with TWI_RESULT_TIMEOUT after this time (checked by TWI_IsIdle with the
+ * Timer2 system tick), a 16-byte read takes 2 ms at 100 kHz so it only fires on a stuck bus.
+ */
+#define TWI_TRANSACTION_TIMEOUT_MS 20
+
+/*******************************************************************************
+ *                    Module Data Types                                        *
+ * *****************************************************************************/
+typedef enum
+{
+	TWI_RESULT_PENDING,	 // queued or running
+	TWI_RESULT_OK,
+	TWI_RESULT_NACK,	 // no slave at the address, or a written byte was not acknowledged
+	TWI_RESULT_ARB_LOST, // another master took the bus
+	TWI_RESULT_BUS_ERROR, // illegal START/STOP on the bus
+	TWI_RESULT_TIMEOUT	 // not complete within TWI_TRANSACTION_TIMEOUT_MS (SCL held, no TWINT), the bus was recovered
+} TWI_ResultType;
+
+/*
+ * One master transaction run by the TWI_vect interrupt:
+ * START, SLA+W, txBuffer, [REPEATED START, SLA+R, rxBuffer], STOP.
+ * txLength = 0 reads only, rxLength = 0 writes only, both 0 only checks that the slave answers.
+ * The buffers are used in place, they must stay valid until the end of the transaction.
+ */
+typedef struct
+{
+	const TWI_DeviceType *device;		 // slave address and bit rate, see TWI_DEVICE
+	const uint8 *txBuffer;				 // bytes written first (register/memory address, data)
+	uint8 txLength;
+	uint8 *rxBuffer;					 // bytes read after the repeated start
+	uint8 rxLength;
+	volatile TWI_ResultType *result;	 // set to the result at the end, NULL_PTR for none
+	void (*callBack)(TWI_ResultType a_result); // called from the ISR at the end, NULL_PTR for none
+} TWI_TransactionType;
+
+/*
+ * Register file served to an external master (slave mode).
+ * A master write starts with the register pointer, the next bytes are written from it with auto-increment.
+ * A master read returns the registers from the pointer with auto-increment (0xFF past the end).
+ */
+typedef struct
+{
+	volatile uint8 *registers;	// register file shared with the application
+	uint8 size;					// number of registers
+	uint8 writableFirst;		// [writableFirst, size) read-write, [0, writableFirst) read-only (writes ignored)
+	void (*writeCallBack)(uint8 a_first, uint8 a_count); // called from the ISR at the end of a master write
+														 // that changed registers, NULL_PTR for none
+} TWI_Slave_RegisterMapType;
+
+/*******************************************************************************
+ *                    Functions Prototypes                                     *
+ *******************************************************************************/
+
+/*
+ * Description : Queue a transaction to be run from the TWI interrupt, the queued transactions run in order
+ * 				 and the CPU is free while the bus is clocked.
+ * arguments   : const TWI_TransactionType *a_transaction : the descriptor is copied, not its buffers
+ * Return      : uint8 : status of the function [TRUE, FALSE (the queue is full)]
+ * Note        : TWI_init and Timer2_Tick_init must be called and the global interrupts enabled,
+ * 				 the blocking TWI functions must not be used while a transaction is running.
+ * 				 *result is set to TWI_RESULT_PENDING here.
+ */
+uint8 TWI_SubmitTransaction(const TWI_TransactionType *a_transaction);
+
+/*
+ * Description : Check if all the queued transactions are complete.
+ * arguments   : None
+ * Return      : uint8 : [TRUE (idle), FALSE (a transaction is running or queued)]
+ * Note        : it is also the watchdog of the queue: a transaction running for more than
+ * 				 TWI_TRANSACTION_TIMEOUT_MS ends with TWI_RESULT_TIMEOUT (TWI_recoverBus) and the next one starts,
+ * 				 so a loop waiting for a result must call it.
+ */
+uint8 TWI_IsIdle(void);
+
+/**************************************** Bus enumeration ********************************************
+ * Blocking probes (START, SLA+W, STOP) with the TWI functions, used once at startup:
+ * not while a transaction of the queue is running or the slave engine is used.
+ *****************************************************************************************************/
+
+/* 7-bit addresses probed by TWI_ScanBus, 0x00..0x07 and 0x78..0x7F are reserved by the I2C specification */
+#define TWI_SCAN_FIRST_ADDRESS 	0x08
+#define TWI_SCAN_LAST_ADDRESS 	0x77
+
+/*
+ * Description : Check if a device acknowledges its address.
+ * arguments   : const TWI_DeviceType *a_device : address and bit rate of the probe
+ * Return      : uint8 : [TRUE (ACK), FALSE (no device, or bus error / timeout)]
+ */
+uint8 TWI_Probe(const TWI_DeviceType *a_device);
+
+/*
+ * Description : Probe every 7-bit address at 100 kHz.
+ * arguments   : uint8 *a_addresses : answering addresses in increasing order
+ * 				 uint8 a_maxCount : size of a_addresses
+ * Return      : uint8 : number of addresses stored in a_addresses
+ * Note        : 112 probes of about 12 SCL periods: 15 ms at 100 kHz (longer if F_CPU limits the rate)
+ */
+uint8 TWI_ScanBus(uint8 *a_addresses, uint8 a_maxCount);
+
+/**************************************** Slave engine ***********************************************
+ * The TWI_vect interrupt answers an external master from a register file, the application only
+ * updates the measurements (TWI_Slave_WriteRegisters) and reads the settings written by the master.
+ * It owns the TWI interrupt call back, so it can't be used with the transaction queue.
+ *****************************************************************************************************/
+
+/*
+ * Description : Answer the master at a_address with the register map a_map.
+ * arguments   : uint8 a_address : own 7-bit slave address
+ * 				 const TWI_Slave_RegisterMapType *a_map : the register map (must stay valid)
+ * Return      : None
+ * Note        : TWI_init must be called first (general call setting) and the global interrupts enabled
+ */
+void TWI_Slave_init(uint8 a_address, const TWI_Slave_RegisterMapType *a_map);
+
+/*
+ * Description : Update a_count registers from a_first at once, so the master never reads half of a
+ * 				 multi-byte value.
+ * arguments   : uint8 a_first : first register
+ * 				 const uint8 *a_data : new values
+ * 				 uint8 a_count : number of registers
+ * Return      : uint8 : status of the function [TRUE, FALSE (the master is reading, try again later)]
+ */
+uint8 TWI_Slave_WriteRegisters(uint8 a_first, const uint8 *a_data, uint8 a_count);
+
+#endif /* TWI_SERVICES_H_ */
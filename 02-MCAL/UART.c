@@ -11,6 +11,10 @@
  *******************************************************************************/
 #include "UART.h"
 #include "BIT_MACROS.h"
+#include "EXTI.h"
+#include "GPIO.h"
+#include "QUEUE.h"
+#include "TIMER.h" // for the system tick
 #include "UART_config.h"
 
 #include <avr/interrupt.h>
@@ -18,16 +22,196 @@
 
 #include "SETTINGS.h" // for F_CPU
 
-#define BAUD_RATE_ASYNC_NORMAL(baud_rate) ((F_CPU / (16UL * (baud_rate))) - 1)
-#define BAUD_RATE_ASYNC_DOUBLE(baud_rate) ((F_CPU / (8UL * (baud_rate))) - 1)
-#define BAUD_RATE_SYNC_MASTER(baud_rate) ((F_CPU / (2UL * (baud_rate))) - 1)
+/*************************** Compile-time UBRR selection ***************************************
+ * All macros are evaluated by the preprocessor/compiler for constant baud rates,
+ * so UART_init does not perform any division at runtime.
+ ***********************************************************************************************/
+/* UBRR rounded to the nearest value (clamped to 0 when the baud rate is above the UART range) */
+#define UART_UBRR_ROUND(baud_rate, divider) \
+	((((F_CPU) + ((divider) / 2UL) * (baud_rate)) / ((divider) * (baud_rate))) > 0 ? \
+		 ((((F_CPU) + ((divider) / 2UL) * (baud_rate)) / ((divider) * (baud_rate))) - 1) : 0)
+
+#define BAUD_RATE_ASYNC_NORMAL(baud_rate) UART_UBRR_ROUND(baud_rate, 16UL)
+#define BAUD_RATE_ASYNC_DOUBLE(baud_rate) UART_UBRR_ROUND(baud_rate, 8UL)
+#define BAUD_RATE_SYNC_MASTER(baud_rate) UART_UBRR_ROUND(baud_rate, 2UL) // 0 (F_CPU / 2) above the range
+
+/* Baud rate error in 0.1 % units for the given divider (16 -> U2X = 0, 8 -> U2X = 1, 2 -> synchronous master) */
+#define UART_ACTUAL_BAUD(baud_rate, divider) ((F_CPU) / ((divider) * (UART_UBRR_ROUND(baud_rate, divider) + 1)))
+#define UART_BAUD_ERROR_DIV(baud_rate, divider)                                                   \
+	((UART_ACTUAL_BAUD(baud_rate, divider) > (baud_rate))                                         \
+		 ? ((UART_ACTUAL_BAUD(baud_rate, divider) - (baud_rate)) * 1000UL / (baud_rate))          \
+		 : (((baud_rate) - UART_ACTUAL_BAUD(baud_rate, divider)) * 1000UL / (baud_rate)))
+
+/* U2X only when it is strictly better, the normal speed receiver takes more samples per bit */
+#define UART_USE_U2X(baud_rate) (UART_BAUD_ERROR_DIV(baud_rate, 8UL) < UART_BAUD_ERROR_DIV(baud_rate, 16UL))
+#define UART_UBRR_VALUE(baud_rate) \
+	(UART_USE_U2X(baud_rate) ? BAUD_RATE_ASYNC_DOUBLE(baud_rate) : BAUD_RATE_ASYNC_NORMAL(baud_rate))
+#define UART_BAUD_ERROR(baud_rate) \
+	(UART_USE_U2X(baud_rate) ? UART_BAUD_ERROR_DIV(baud_rate, 8UL) : UART_BAUD_ERROR_DIV(baud_rate, 16UL))
+
+/*
+ * a baud rate is compiled in only if it can be generated from F_CPU within the error budget,
+ * in synchronous mode both sides use the same clock so only the range matters:
+ * the master divides F_CPU by 2 * (UBRR + 1) and the slave can follow up to F_CPU / 4.
+ */
+#if (SYNCH_MODE == ASYNCH)
+	#define UART_BAUD_USABLE(baud_rate) (UART_BAUD_ERROR(baud_rate) <= UART_MAX_BAUD_ERROR)
+#elif (SYNCH_MODE == SYNCH) && (UART_SYNCH_ROLE == UART_SYNCH_MASTER)
+	#define UART_BAUD_USABLE(baud_rate) ((baud_rate) <= (F_CPU) / 2UL)
+#elif (SYNCH_MODE == SYNCH) && (UART_SYNCH_ROLE == UART_SYNCH_SLAVE)
+	#define UART_BAUD_USABLE(baud_rate) ((baud_rate) <= (F_CPU) / 4UL)
+#else
+	#error "SYNCH_MODE must be SYNCH or ASYNCH and UART_SYNCH_ROLE UART_SYNCH_MASTER or UART_SYNCH_SLAVE"
+#endif
+
+#if !UART_BAUD_USABLE(UART_APP_BAUD_RATE)
+	#error "UART_APP_BAUD_RATE can't be generated from F_CPU within UART_MAX_BAUD_ERROR"
+#endif
+
+#if (SYNCH_MODE == ASYNCH)
+	#define UART_SELECT_BAUD(baud_rate)                   \
+		do                                                \
+		{                                                 \
+			UBRR_var = (uint16)UART_UBRR_VALUE(baud_rate); \
+			doubleSpeed = UART_USE_U2X(baud_rate);        \
+		} while (0)
+#elif (UART_SYNCH_ROLE == UART_SYNCH_MASTER)
+	/* U2X must be 0 in synchronous mode */
+	#define UART_SELECT_BAUD(baud_rate)                          \
+		do                                                       \
+		{                                                        \
+			UBRR_var = (uint16)BAUD_RATE_SYNC_MASTER(baud_rate); \
+			doubleSpeed = FALSE;                                 \
+		} while (0)
+#else
+	/* the slave is clocked by the master on XCK, UBRR is not used */
+	#define UART_SELECT_BAUD(baud_rate) \
+		do                              \
+		{                               \
+			UBRR_var = 0;               \
+			doubleSpeed = FALSE;        \
+		} while (0)
+#endif
 
 /*************************** Pointer to functions to be assigned to ISR ********************************/
 static void (*UART_RX_callBackPtr)(void) = NULL_PTR;
 static void (*UART_TX_callBackPtr)(void) = NULL_PTR;
+static void (*UART_UDRE_callBackPtr)(void) = NULL_PTR;
 
 volatile uint8 receivedByte; // Global variable to store the received byte
 
+/*************************** Multi-processor communication mode ***************************/
+static volatile boolean UART_MPCM_enabled = FALSE;
+static uint8 UART_MPCM_ownAddress = 0;
+
+/*************************** Line health counters ***************************/
+static volatile UART_StatsType UART_Stats = {0};
+
+/*
+ * The counters are updated from the ISRs and from the blocking functions, the 32-bit increments
+ * are done with the interrupts disabled so none is lost or torn.
+ */
+#define UART_COUNT_TX_BYTE()                                        \
+	do                                                              \
+	{                                                               \
+		uint8 sreg_count = SREG;                                    \
+		cli();                                                      \
+		UART_Stats.tx_bytes++;                                      \
+		SREG = sreg_count;                                          \
+	} while (0)
+
+/*
+ * Count the receive errors of the byte on top of the receive FIFO,
+ * UCSRA must be read before UDR as reading UDR moves the FIFO and its error flags.
+ */
+#define UART_COUNT_RX_ERRORS(status)                                \
+	do                                                              \
+	{                                                               \
+		uint8 sreg_count = SREG;                                    \
+		cli();                                                      \
+		if ((status) & (BIT(FE) | BIT(DOR) | BIT(PE)))              \
+		{                                                           \
+			if (IS_BIT_SET(status, FE))                             \
+				UART_Stats.frame_errors++;                          \
+			if (IS_BIT_SET(status, DOR))                            \
+				UART_Stats.data_overruns++;                         \
+			if (IS_BIT_SET(status, PE))                             \
+				UART_Stats.parity_errors++;                         \
+		}                                                           \
+		UART_Stats.rx_bytes++;                                      \
+		SREG = sreg_count;                                          \
+	} while (0)
+
+/*************************** TX/RX queues - MODE == INTERRUPT - ***************************************/
+#if (MODE == INTERRUPT)
+	#if ((UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) != 0) || (UART_TX_BUFFER_SIZE > 128)
+		#error "UART_TX_BUFFER_SIZE must be a power of two not greater than 128"
+	#endif
+	#if ((UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) != 0) || (UART_RX_BUFFER_SIZE > 128)
+		#error "UART_RX_BUFFER_SIZE must be a power of two not greater than 128"
+	#endif
+
+/*
+ * Lock-free SPSC queues (QUEUE.h), the main loop and the ISRs never disable interrupts for them.
+ * UART_TxQueue : produced by UART_WriteByte, consumed by the UDRE ISR
+ * UART_RxQueue : produced by the RXC ISR, consumed by UART_ReadByte
+ * UART_RxNinthQueue : RXB8 of every byte of UART_RxQueue (9-bit data), pushed and popped with it
+ */
+QUEUE_DEFINE(UART_TxQueue, uint8, UART_TX_BUFFER_SIZE)
+QUEUE_DEFINE(UART_RxQueue, uint8, UART_RX_BUFFER_SIZE)
+QUEUE_DEFINE(UART_RxNinthQueue, uint8, UART_RX_BUFFER_SIZE)
+#endif
+
+/*************************** RTS/CTS flow control ***************************/
+#if (FLOW_CONTROL == FLOW_CONTROL_RTS_CTS)
+	#if (MODE != INTERRUPT)
+		#error "RTS/CTS flow control needs the RX/TX queues (MODE == INTERRUPT)"
+	#endif
+	#if (UART_RX_HIGH_WATER >= UART_RX_BUFFER_SIZE) || (UART_RX_LOW_WATER >= UART_RX_HIGH_WATER)
+		#error "UART_RX_LOW_WATER < UART_RX_HIGH_WATER < UART_RX_BUFFER_SIZE is required"
+	#endif
+
+static volatile boolean UART_RTS_asserted = FALSE;
+static volatile boolean UART_TX_paused = FALSE; // the UDRE ISR stopped because of CTS, UART_TX_Resume restarts it
+
+	#define UART_RTS_ASSERT()                                                \
+		do                                                                   \
+		{                                                                    \
+			GPIO_writePin(UART_RTS_PORT_ID, UART_RTS_PIN_ID, LOGIC_LOW);     \
+			UART_RTS_asserted = TRUE;                                        \
+		} while (0)
+	#define UART_RTS_DEASSERT()                                              \
+		do                                                                   \
+		{                                                                    \
+			GPIO_writePin(UART_RTS_PORT_ID, UART_RTS_PIN_ID, LOGIC_HIGH);    \
+			UART_RTS_asserted = FALSE;                                       \
+		} while (0)
+	#define UART_CTS_IS_ASSERTED() (GPIO_readPin(UART_CTS_PORT_ID, UART_CTS_PIN_ID) == LOGIC_LOW)
+
+	/* the CTS pin must be the pin of its external interrupt */
+	#if (UART_CTS_INT == UART_CTS_INT0)
+		#if (UART_CTS_PORT_ID != PORTD_ID) || (UART_CTS_PIN_ID != PIN2_ID)
+			#error "UART_CTS_INT0 needs CTS on PD2"
+		#endif
+		#define UART_CTS_INTF INTF0
+	#elif (UART_CTS_INT == UART_CTS_INT1)
+		#if (UART_CTS_PORT_ID != PORTD_ID) || (UART_CTS_PIN_ID != PIN3_ID)
+			#error "UART_CTS_INT1 needs CTS on PD3"
+		#endif
+		#define UART_CTS_INTF INTF1
+	#elif (UART_CTS_INT == UART_CTS_INT2)
+		#if (UART_CTS_PORT_ID != PORTB_ID) || (UART_CTS_PIN_ID != PIN2_ID)
+			#error "UART_CTS_INT2 needs CTS on PB2"
+		#endif
+		#define UART_CTS_INTF INTF2
+	#endif
+
+	#if (UART_CTS_INT != UART_CTS_INT_NONE)
+/* CTS asserted (falling edge): restart the transmission paused by the UDRE ISR */
+static Interrupt_ConfigType UART_CTS_Config = {(EXTI_Interrupt)UART_CTS_INT, falling_edge};
+	#endif
+#endif
+
 /************************* Array of  UBRR values ***************************/
 
 // const uint16 BaudRateArray[TOTAL_SPEED_MODE][TOTAL_CPU_F][TOTAL_BAUD_RATE] =
@@ -35,22 +219,28 @@ volatile uint8 receivedByte; // Global variable to store the received byte
 //	 {{207, 103, 51, 34, 25, 16, 0}, {416, 207, 103, 68, 51, 34, 8}, {832, 416, 207, 138, 103, 68, 16}}};
 
 /******************************************* initialization  *********************************************/
-void UART_init(UART_ConfigType *a_config_ptr)
+uint8 UART_init(UART_ConfigType *a_config_ptr)
 {
 
 	volatile uint8 UCSRC_var = 0; // write UCSRC settings in one step then write it to UCSRC register
 	uint16 UBRR_var = 0;
-
-	//***************************** transmission speed ***************************/
-#if (SPEED_MODE == NORMAL_SPEED)
-	CLEAR_BIT(UCSRA, U2X);
-#elif (SPEED_MODE == DOUBLE_SPEED)
-	SET_BIT(UCSRA, U2X);
-#endif
+	boolean doubleSpeed = FALSE;
 
 	//********************* Communication mode *******************************/
 #if (SYNCH_MODE == SYNCH)
-	SET_BIT(UCSRC_var, UMSEL)
+	SET_BIT(UCSRC_var, UMSEL);
+
+	// clock polarity (UCPOL is only used in synchronous mode)
+	#if (UART_CLOCK_POLARITY == UART_TX_FALLING_RX_RISING)
+	SET_BIT(UCSRC_var, UCPOL);
+	#endif
+
+	// the XCK direction selects the role: output -> master, input -> slave
+	#if (UART_SYNCH_ROLE == UART_SYNCH_MASTER)
+	GPIO_setupPinDirection(UART_XCK_PORT_ID, UART_XCK_PIN_ID, PIN_OUTPUT);
+	#else
+	GPIO_setupPinDirection(UART_XCK_PORT_ID, UART_XCK_PIN_ID, PIN_INPUT);
+	#endif
 #elif (SYNCH_MODE == ASYNCH)
 	CLEAR_BIT(UCSRC_var, UMSEL);
 #endif
@@ -59,31 +249,110 @@ void UART_init(UART_ConfigType *a_config_ptr)
 	UCSRC_var = (UCSRC_var & 0xCF) | ((a_config_ptr->parity) << 4);
 
 	//*********************** Number of data bits *******************************/
-	UCSRC_var = (UCSRC_var & 0xF9) | ((a_config_ptr->bit_data) << 1);
 	if (a_config_ptr->bit_data == UART_9_BIT_DATA)
+	{
+		// UCSZ2:0 = 111
+		SET_MASK(UCSRC_var, BIT(UCSZ1) | BIT(UCSZ0));
 		SET_BIT(UCSRB, UCSZ2);
+	}
+	else
+	{
+		UCSRC_var = (UCSRC_var & 0xF9) | ((a_config_ptr->bit_data) << 1);
+		CLEAR_BIT(UCSRB, UCSZ2);
+	}
 
 	//*********************** Number of stop bits *******************************/
 	UCSRC_var = (UCSRC_var & 0xF7) | ((a_config_ptr->stop_bit) << 3);
 
 	//****************** Set URSEL to access UCSRC register *********************/
-	SET_BIT(UCSRC, URSEL);
+	// UCSRC shares its address with UBRRH, URSEL must be set in the same write
+	SET_BIT(UCSRC_var, URSEL);
 
 	//***************** Write UCSRC register *******************************/
 	UCSRC = UCSRC_var;
 
 	//************************ Set baud rate *******************************/
-#if (SYNCH_MODE == ASYNCH)
-	#if (SPEED_MODE == NORMAL_SPEED)
-	UBRR_var = BAUD_RATE_ASYNC_NORMAL(a_config_ptr->baud_rate)
-	#elif (SPEED_MODE == DOUBLE_SPEED)
-	UBRR_var = (uint16)BAUD_RATE_ASYNC_DOUBLE(a_config_ptr->baud_rate);
-	#endif
-#elif (SYNCH_MODE == SYNCH)
-	UBRR_var = BAUD_RATE_SYNC_MASTER(a_config_ptr->baud_rate);
+	/*
+	 * Every case is a constant, so UBRR and U2X are computed at compile time.
+	 * Baud rates out of the error budget are not compiled in, the UART is then left disabled.
+	 */
+	switch (a_config_ptr->baud_rate)
+	{
+#if UART_BAUD_USABLE(2400UL)
+	case BAUD_2400:
+		UART_SELECT_BAUD(2400UL);
+		break;
+#endif
+#if UART_BAUD_USABLE(4800UL)
+	case BAUD_4800:
+		UART_SELECT_BAUD(4800UL);
+		break;
+#endif
+#if UART_BAUD_USABLE(9600UL)
+	case BAUD_9600:
+		UART_SELECT_BAUD(9600UL);
+		break;
+#endif
+#if UART_BAUD_USABLE(14400UL)
+	case BAUD_14400:
+		UART_SELECT_BAUD(14400UL);
+		break;
+#endif
+#if UART_BAUD_USABLE(19200UL)
+	case BAUD_19200:
+		UART_SELECT_BAUD(19200UL);
+		break;
+#endif
+#if UART_BAUD_USABLE(28800UL)
+	case BAUD_28800:
+		UART_SELECT_BAUD(28800UL);
+		break;
+#endif
+#if UART_BAUD_USABLE(38400UL)
+	case BAUD_38400:
+		UART_SELECT_BAUD(38400UL);
+		break;
 #endif
+#if UART_BAUD_USABLE(57600UL)
+	case BAUD_57600:
+		UART_SELECT_BAUD(57600UL);
+		break;
+#endif
+#if UART_BAUD_USABLE(115200UL)
+	case BAUD_115200:
+		UART_SELECT_BAUD(115200UL);
+		break;
+#endif
+#if UART_BAUD_USABLE(250000UL)
+	case BAUD_250000:
+		UART_SELECT_BAUD(250000UL);
+		break;
+#endif
+#if UART_BAUD_USABLE(500000UL)
+	case BAUD_500000:
+		UART_SELECT_BAUD(500000UL);
+		break;
+#endif
+#if UART_BAUD_USABLE(1000000UL)
+	case BAUD_1000000:
+		UART_SELECT_BAUD(1000000UL);
+		break;
+#endif
+	default:
+		return FALSE;
+	}
 
-		UBRRH = (uint8)(UBRR_var >> 8);
+	//***************************** transmission speed ***************************/
+	if (doubleSpeed == TRUE)
+	{
+		SET_BIT(UCSRA, U2X);
+	}
+	else
+	{
+		CLEAR_BIT(UCSRA, U2X);
+	}
+
+	UBRRH = (uint8)(UBRR_var >> 8);
 	UBRRL = (uint8)UBRR_var;
 
 	//************************ Enable receiver and transmitter *******************************/
@@ -91,6 +360,50 @@ void UART_init(UART_ConfigType *a_config_ptr)
 	SET_BIT(UCSRB, RXEN);
 	// enable UART  transmitter .
 	SET_BIT(UCSRB, TXEN);
+
+#if (FLOW_CONTROL == FLOW_CONTROL_RTS_CTS)
+	GPIO_setupPinDirection(UART_CTS_PORT_ID, UART_CTS_PIN_ID, PIN_INPUT);
+	GPIO_writePin(UART_CTS_PORT_ID, UART_CTS_PIN_ID, LOGIC_HIGH); // pull up, no peer -> no transmission
+	GPIO_setupPinDirection(UART_RTS_PORT_ID, UART_RTS_PIN_ID, PIN_OUTPUT);
+	UART_RTS_ASSERT(); // ready to receive
+
+	#if (UART_CTS_INT != UART_CTS_INT_NONE)
+	EXTI_init(&UART_CTS_Config);
+	EXTI_setCallBack(&UART_CTS_Config, UART_TX_Resume);
+	GIFR = BIT(UART_CTS_INTF); // edges before the init
+	EXTI_enable(&UART_CTS_Config);
+	#endif
+#endif
+
+#if (MODE == INTERRUPT)
+	// the RX queue is filled by the receive complete interrupt
+	SET_BIT(UCSRB, RXCIE);
+#endif
+
+	return TRUE;
+}
+
+/**************************************** Baud rate registers *************************************************/
+void UART_SetUBRR(uint16 a_ubrr, uint8 a_doubleSpeed)
+{
+	// wait for UDR to be empty, a byte still in the shift register is finished with the new bit time
+	if (IS_BIT_SET(UCSRB, TXEN))
+	{
+		while (IS_BIT_CLEAR(UCSRA, UDRE))
+			;
+	}
+
+	if (a_doubleSpeed == TRUE)
+	{
+		SET_BIT(UCSRA, U2X);
+	}
+	else
+	{
+		CLEAR_BIT(UCSRA, U2X);
+	}
+
+	UBRRH = (uint8)(a_ubrr >> 8);
+	UBRRL = (uint8)a_ubrr;
 }
 
 /**************************************** Interrupt Enable/Disable ********************************************/
@@ -114,6 +427,16 @@ void UART_TX_InterruptDisable(void)
 	CLEAR_BIT(UCSRB, TXCIE);
 }
 
+void UART_UDRE_InterruptEnable(void)
+{
+	SET_BIT(UCSRB, UDRIE);
+}
+
+void UART_UDRE_InterruptDisable(void)
+{
+	CLEAR_BIT(UCSRB, UDRIE);
+}
+
 /**************************************** Set Call Back Functions ********************************************/
 void UART_RX_SetCallBack(void (*LocalFptr)(void))
 {
@@ -125,9 +448,66 @@ void UART_TX_SetCallBack(void (*LocalFptr)(void))
 	UART_TX_callBackPtr = LocalFptr;
 }
 
+void UART_UDRE_SetCallBack(void (*LocalFptr)(void))
+{
+	UART_UDRE_callBackPtr = LocalFptr;
+}
+
+/*********************************** Multi-processor address filter ********************************************/
+/*
+ * Return TRUE if the received byte is data for this node.
+ * While MPCM is set the hardware drops data frames (9th bit = 0), so only address frames interrupt the CPU.
+ * A matching address frame clears MPCM to receive the following data frames,
+ * any other address frame sets it again.
+ */
+static uint8 UART_MPCM_Filter(uint8 a_ninthBit, uint8 a_data)
+{
+	if (UART_MPCM_enabled == FALSE || a_ninthBit == 0)
+	{
+		return TRUE;
+	}
+
+	if (a_data == UART_MPCM_ownAddress)
+	{
+		CLEAR_BIT(UCSRA, MPCM);
+	}
+	else
+	{
+		SET_BIT(UCSRA, MPCM);
+	}
+	return FALSE;
+}
+
 /********************************************** ISR ************************************************************/
 ISR(USART_RXC_vect) // ISR for receive complete interrupt
 {
+#if (MODE == INTERRUPT)
+	uint8 status = UCSRA;
+	uint8 ninthBit = READ_BIT(UCSRB, RXB8); // RXB8 must be read before UDR
+	uint8 data = UDR;						// reading UDR clears RXC
+
+	UART_COUNT_RX_ERRORS(status);
+
+	if (UART_MPCM_Filter(ninthBit, data) == FALSE)
+	{
+		// address frame, consumed by the filter
+	}
+	else if (UART_RxQueue_Push(data) == FALSE)
+	{
+		UART_Stats.rx_queue_overflows++;
+	}
+	else
+	{
+		(void)UART_RxNinthQueue_Push(ninthBit); // same size as UART_RxQueue, always room
+	}
+
+	#if (FLOW_CONTROL == FLOW_CONTROL_RTS_CTS)
+	if (UART_RTS_asserted == TRUE && UART_RxQueue_Count() >= UART_RX_HIGH_WATER)
+	{
+		UART_RTS_DEASSERT(); // ask the other device to stop sending
+	}
+	#endif
+#endif
 	if (UART_RX_callBackPtr != NULL_PTR)
 	{
 		UART_RX_callBackPtr();
@@ -142,25 +522,69 @@ ISR(USART_TXC_vect) // ISR for transmit complete interrupt
 	}
 }
 
+ISR(USART_UDRE_vect) // ISR for data register empty interrupt
+{
+#if (FLOW_CONTROL == FLOW_CONTROL_RTS_CTS)
+	if (!UART_CTS_IS_ASSERTED())
+	{
+		// the other device can't receive, pause until UART_TX_Resume (CTS edge) or UART_WriteByte
+		CLEAR_BIT(UCSRB, UDRIE);
+		UART_TX_paused = TRUE;
+		return;
+	}
+#endif
+#if (MODE == INTERRUPT)
+	uint8 data;
+	if (UART_TxQueue_Pop(&data) == TRUE)
+	{
+		UDR = data;
+		UART_COUNT_TX_BYTE();
+		return;
+	}
+#endif
+	if (UART_UDRE_callBackPtr != NULL_PTR)
+	{
+		// the call back sends the next byte, or disables the interrupt when it has nothing left
+		UART_UDRE_callBackPtr();
+	}
+	else
+	{
+		// nothing left to send, UDRE stays set so the interrupt must be disabled
+		CLEAR_BIT(UCSRB, UDRIE);
+	}
+}
+
 /********************************** Send and receive functions with polling **************************************/
 void UART_SendByte(uint8 a_data)
 {
+#if (MODE == INTERRUPT)
+	while (UART_WriteByte(a_data) == FALSE) // wait only while the TX buffer is full
+		;
+#else
 	/* UDRE flag is set when the Tx buffer (UDR) is empty and ready
 	for transmitting a new byte so wait until this flag is set to one */
 	while (IS_BIT_CLEAR(UCSRA, UDRE)) // Busy wait polling
 		;
 	/* the UDRE flag will be cleared by hardware when u write new data to buffer.*/
 	UDR = a_data;
+	UART_COUNT_TX_BYTE();
 
 	// ================== Another Method ==================
 	// UDR = a_data;
 	// while (BIT_IS_CLEAR(UCSRA, TXC)) // Wait until the transmission is complete TXC = 1
 	//	;
 	// SET_BIT(UCSRA, TXC); // Clear the TXC flag
+#endif
 }
 
 uint8 UART_ReceiveByte(void)
 {
+#if (MODE == INTERRUPT)
+	uint8 data;
+	while (UART_ReadByte(&data) == FALSE) // wait until the RXC ISR queues a byte
+		;
+	return data;
+#else
 	/* RXC flag is set when the UART receive data so  wait until this flag is set to one
 	and it will cleared by hardware when u read the data */
 	while (IS_BIT_CLEAR(UCSRA, RXC)) // Busy wait polling
@@ -170,36 +594,268 @@ uint8 UART_ReceiveByte(void)
 	 * FE: Frame Error (Stop Bit)
 	 * DOR: Data OverRun
 	 * PE: Parity Error
+	 * the errors are counted in the line health counters (UART_GetStats)
 	 *******************************************************************/
-	// if (IS_BIT_SET(UCSRA, FE) || IS_BIT_SET(UCSRA, DOR) || IS_BIT_SET(UCSRA, PE))
-	//{
-	//	return 0; // return 0 if there is error in receiving
-	// }
-	// else
-	//{
-	//	return UDR;
-	// }
+	uint8 status = UCSRA;
+	UART_COUNT_RX_ERRORS(status);
 	return UDR;
+#endif
+}
+
+UART_StatusType UART_ReceiveByteTimeout(uint8 *ptr_data, uint16 a_timeout_ms)
+{
+	uint32 start = Timer2_Tick_getMs();
+
+	while (UART_ReceiveByteCheck(ptr_data) == FALSE)
+	{
+		if ((uint32)(Timer2_Tick_getMs() - start) >= a_timeout_ms)
+		{
+			return UART_TIMEOUT;
+		}
+	}
+	return UART_OK;
 }
 
 uint8 UART_ReceiveByteCheck(uint8 *ptr_data)
 {
+#if (MODE == INTERRUPT)
+	return UART_ReadByte(ptr_data);
+#else
 	uint8 status = FALSE;
-	if (IS_BIT_SET(UCSRA, RXC))
+	uint8 flags = UCSRA;
+	if (IS_BIT_SET(flags, RXC))
 	{
+		UART_COUNT_RX_ERRORS(flags);
 		*ptr_data = UDR;
 		status = TRUE;
 	}
 	return status;
+#endif
 }
 
 /********************************* Send and receive functions with no ckecking - for interrupt - *******************/
 void UART_SendByteNoBlock(uint8 a_data)
 {
 	UDR = a_data;
+	UART_COUNT_TX_BYTE();
 }
 
 uint8 UART_ReceiveByteNoBlock(void)
 {
+#if (MODE != INTERRUPT) // in buffered mode the RXC ISR already counted the byte
+	uint8 status = UCSRA;
+	UART_COUNT_RX_ERRORS(status);
+#endif
 	return UDR;
 }
+
+/********************************************* Line health counters ***********************************************/
+void UART_GetStats(UART_StatsType *a_stats_ptr)
+{
+	uint8 sreg = SREG; // the counters are updated from the ISRs, copy them with interrupts disabled
+	cli();
+	*a_stats_ptr = UART_Stats;
+	SREG = sreg;
+}
+
+void UART_ClearStats(void)
+{
+	uint8 sreg = SREG;
+	cli();
+	UART_Stats.frame_errors = 0;
+	UART_Stats.data_overruns = 0;
+	UART_Stats.parity_errors = 0;
+	UART_Stats.rx_queue_overflows = 0;
+	UART_Stats.rx_bytes = 0;
+	UART_Stats.tx_bytes = 0;
+	SREG = sreg;
+}
+
+/********************************* Buffered send and receive functions - MODE == INTERRUPT - ***********************/
+#if (MODE == INTERRUPT)
+uint8 UART_WriteByte(uint8 a_data)
+{
+	uint8 status = UART_TxQueue_Push(a_data);
+
+	// (re)start the transmission even when the queue is full: a pause by CTS must end
+	// while UART_SendByte waits for space, the UDRE ISR checks CTS again
+	SET_BIT(UCSRB, UDRIE);
+	return status;
+}
+
+/* oldest received byte and its 9th bit */
+static uint8 UART_RxPop(uint8 *ptr_data, uint8 *ptr_ninthBit)
+{
+	uint8 status = UART_RxQueue_Pop(ptr_data);
+
+	if (status == TRUE)
+	{
+		(void)UART_RxNinthQueue_Pop(ptr_ninthBit); // pushed by the ISR together with the byte
+	}
+
+	#if (FLOW_CONTROL == FLOW_CONTROL_RTS_CTS)
+	if (UART_RTS_asserted == FALSE)
+	{
+		uint8 sreg = SREG; // the RXC ISR may deassert RTS between the check and the write
+		cli();
+		if (UART_RxQueue_Count() <= UART_RX_LOW_WATER)
+		{
+			UART_RTS_ASSERT(); // enough space again
+		}
+		SREG = sreg;
+	}
+	#endif
+	return status;
+}
+
+uint8 UART_ReadByte(uint8 *ptr_data)
+{
+	uint8 ninthBit;
+
+	return UART_RxPop(ptr_data, &ninthBit);
+}
+
+void UART_TX_Resume(void)
+{
+	/* bytes of the queue, or of the UDRE call back (UART_SendBufferAsync descriptors),
+	 * the call back disables the interrupt itself when it has nothing to send */
+#if (FLOW_CONTROL == FLOW_CONTROL_RTS_CTS)
+	UART_TX_paused = FALSE;
+#endif
+	if (UART_TxQueue_Count() != 0 || UART_UDRE_callBackPtr != NULL_PTR)
+	{
+		SET_BIT(UCSRB, UDRIE); // the UDRE ISR checks CTS again
+	}
+}
+
+/*
+ * Nothing queued, streamed (UDRE call back) or paused by CTS, and UDR empty: a byte written to UDR
+ * now is not sent in the middle of a buffered transmission. Called with the interrupts disabled.
+ */
+static boolean UART_TX_IsIdle(void)
+{
+	if (UART_TxQueue_Count() != 0 || IS_BIT_SET(UCSRB, UDRIE) || IS_BIT_CLEAR(UCSRA, UDRE))
+	{
+		return FALSE;
+	}
+#if (FLOW_CONTROL == FLOW_CONTROL_RTS_CTS)
+	if (UART_TX_paused == TRUE || !UART_CTS_IS_ASSERTED())
+	{
+		return FALSE;
+	}
+#endif
+	return TRUE;
+}
+
+uint8 UART_GetTxFree(void)
+{
+	return UART_TxQueue_Free();
+}
+
+uint8 UART_GetRxAvailable(void)
+{
+	return UART_RxQueue_Count();
+}
+#endif
+
+/********************************* 9-bit and multi-processor communication mode ************************************/
+void UART_SendByte9(uint16 a_data)
+{
+#if (MODE == INTERRUPT)
+	uint8 sreg;
+
+	/* the TX queue can't carry the 9th bit: wait until the buffered transmission is over */
+	while (1)
+	{
+		sreg = SREG;
+		cli();
+		if (UART_TX_IsIdle() == TRUE)
+		{
+			break; // the interrupts stay disabled until UDR is written
+		}
+		SREG = sreg;
+	#if (FLOW_CONTROL == FLOW_CONTROL_RTS_CTS)
+		if (UART_TX_paused == TRUE)
+		{
+			UART_TX_Resume(); // a pause by CTS must not block the drain
+		}
+	#endif
+	}
+#else
+	while (IS_BIT_CLEAR(UCSRA, UDRE))
+		;
+#endif
+	/* TXB8 must be written before UDR, both are moved together to the shift register */
+	WRITE_BIT(UCSRB, TXB8, (uint8)((a_data >> 8) & 1U));
+	UDR = (uint8)a_data;
+	UART_COUNT_TX_BYTE();
+#if (MODE == INTERRUPT)
+	SREG = sreg;
+#endif
+}
+
+uint16 UART_ReceiveByte9(void)
+{
+#if (MODE == INTERRUPT)
+	uint8 data;
+	uint8 ninthBit;
+
+	while (UART_RxPop(&data, &ninthBit) == FALSE) // the RXC ISR already read UDR and RXB8
+		;
+	return ((uint16)ninthBit << 8) | data;
+#else
+	uint8 status;
+	uint8 ninthBit;
+
+	while (IS_BIT_CLEAR(UCSRA, RXC))
+		;
+	status = UCSRA;
+	UART_COUNT_RX_ERRORS(status);
+	ninthBit = READ_BIT(UCSRB, RXB8); // RXB8 must be read before UDR
+	return ((uint16)ninthBit << 8) | UDR;
+#endif
+}
+
+void UART_MPCM_init(uint8 a_address)
+{
+	UART_MPCM_ownAddress = a_address;
+	UART_MPCM_enabled = TRUE;
+
+	// ignore data frames until this node is addressed
+	SET_BIT(UCSRA, MPCM);
+}
+
+void UART_MPCM_SendAddress(uint8 a_address)
+{
+	UART_SendByte9((uint16)0x100 | a_address);
+
+	/* wait until the address is in the shift register, then the next bytes are data frames (9th bit = 0) */
+	while (IS_BIT_CLEAR(UCSRA, UDRE))
+		;
+	CLEAR_BIT(UCSRB, TXB8);
+}
+
+uint8 UART_MPCM_ReceiveData(uint8 *ptr_data)
+{
+#if (MODE == INTERRUPT)
+	return UART_ReadByte(ptr_data); // the RXC ISR already filtered the address frames
+#else
+	uint8 status = FALSE;
+	uint8 flags = UCSRA;
+	uint8 ninthBit;
+	uint8 data;
+
+	if (IS_BIT_SET(flags, RXC))
+	{
+		UART_COUNT_RX_ERRORS(flags);
+		ninthBit = READ_BIT(UCSRB, RXB8);
+		data = UDR;
+		if (UART_MPCM_Filter(ninthBit, data) == TRUE)
+		{
+			*ptr_data = data;
+			status = TRUE;
+		}
+	}
+	return status;
+#endif
+}
@@ -30,7 +30,12 @@ typedef enum
 	BAUD_14400 = 14400,
 	BAUD_19200 = 19200,
 	BAUD_28800 = 28800,
-	BAUD_115200 = 115200
+	BAUD_38400 = 38400,
+	BAUD_57600 = 57600,
+	BAUD_115200 = 115200,
+	BAUD_250000 = 250000,  // synchronous mode rates (F_CPU / 2 master, F_CPU / 4 slave at most)
+	BAUD_500000 = 500000,
+	BAUD_1000000 = 1000000
 } UART_BaudRate;
 typedef enum
 {
@@ -53,6 +58,23 @@ typedef struct
 	UART_BaudRate baud_rate;
 } UART_ConfigType;
 
+typedef enum
+{
+	UART_OK,
+	UART_TIMEOUT,
+	UART_OVERFLOW
+} UART_StatusType;
+
+typedef struct
+{
+	uint16 frame_errors;	   // FE  : stop bit was read as zero
+	uint16 data_overruns;	   // DOR : a byte was lost because the receive FIFO was full
+	uint16 parity_errors;	   // PE  : parity check failed
+	uint16 rx_queue_overflows; // received bytes dropped because the RX buffer was full (MODE == INTERRUPT)
+	uint32 rx_bytes;		   // bytes read from UDR
+	uint32 tx_bytes;		   // bytes written to UDR
+} UART_StatsType;
+
 /*
  * Description : initialize UART driver with specific baud rate and other static configurations:
  * 			 	 - number of data bits.
@@ -61,14 +83,16 @@ typedef struct
  * 			 	 - communication mode.
  * 			 	 - speed mode.
  * arguments   : uint32 a_baud_rate : baud rate of the UART communication
- * Return  : None
+ * Return  : uint8 : TRUE, or FALSE if the baud rate can't be generated from F_CPU within UART_MAX_BAUD_ERROR
+ * 			 (the UART is then left disabled)
  */
-void UART_init(UART_ConfigType *a_config_ptr);
+uint8 UART_init(UART_ConfigType *a_config_ptr);
 
 /*
  * Description : Functional responsible for send byte to another UART device.
  * arguments   : uint8 a_data : byte to be sent
  * Return  : None
+ * Note : when MODE == INTERRUPT it only waits while the TX buffer is full
  */
 void UART_SendByte(uint8 a_data);
 
@@ -77,9 +101,19 @@ void UART_SendByte(uint8 a_data);
  * arguments   : None
  * Return  : uint8 : received byte
  * Note : this function is blocking function until receive byte - busy waiting polling method -
+ * 		  when MODE == INTERRUPT it waits on the RX buffer instead of the RXC flag
  */
 uint8 UART_ReceiveByte(void);
 
+/*
+ * Description : Receive byte from another UART device, giving up after a timeout.
+ * arguments   : uint8 *ptr_data : pointer to the variable which will store the received byte
+ * 				 uint16 a_timeout_ms : maximum waiting time in milliseconds
+ * Return : UART_StatusType : [UART_OK, UART_TIMEOUT]
+ * Note : the timeout is measured with the Timer2 system tick (Timer2_Tick_init must be called)
+ */
+UART_StatusType UART_ReceiveByteTimeout(uint8 *ptr_data, uint16 a_timeout_ms);
+
 /*
  * Description : Receive byte from another UART device using periodic check on the receive flag.
  * arguments   : uint8 *ptr_data : pointer to the variable which will store the received byte
@@ -93,13 +127,134 @@ void UART_RX_InterruptEnable(void);
 void UART_RX_InterruptDisable(void);
 void UART_TX_InterruptEnable(void);
 void UART_TX_InterruptDisable(void);
+void UART_UDRE_InterruptEnable(void);
+void UART_UDRE_InterruptDisable(void);
 
 /***************************************** Call Back Functions ***********************************************/
+/*
+ * RX call back: called from the RXC interrupt. With MODE == INTERRUPT the ISR has already read UDR
+ * into the RX queue, so the call back must get the bytes with UART_ReadByte (not UDR or UART_ReceiveByteNoBlock).
+ */
 void UART_RX_SetCallBack(void (*LocalFptr)(void));
 void UART_TX_SetCallBack(void (*LocalFptr)(void));
+/*
+ * UDRE call back: called when UDR is empty and no byte is waiting in the TX queue (MODE == INTERRUPT),
+ * it must send the next byte (UART_SendByteNoBlock) or disable the UDRE interrupt.
+ */
+void UART_UDRE_SetCallBack(void (*LocalFptr)(void));
 
 /***************************************** Send/Receive No Block - for interrupt -****************************/
 void UART_SendByteNoBlock(uint8 a_data);
 uint8 UART_ReceiveByteNoBlock(void);
 
+/***************************************** 9-bit Data ********************************************************/
+/*
+ * Description : Send a 9-bit frame (the UART must be initialized with UART_9_BIT_DATA).
+ * arguments   : uint16 a_data : bits 0..7 are the data, bit 8 is the 9th bit (TXB8)
+ * Return : None
+ * Note : with MODE == INTERRUPT it blocks until the buffered transmission is over (TX queue and
+ * 		  UART_SendBufferAsync buffers sent, and CTS asserted with flow control), then writes UDR itself
+ */
+void UART_SendByte9(uint16 a_data);
+
+/*
+ * Description : Receive a 9-bit frame (the UART must be initialized with UART_9_BIT_DATA).
+ * Return : uint16 : bits 0..7 are the data, bit 8 is the 9th bit (RXB8)
+ * Note : this function is blocking function until receive byte,
+ * 		  with MODE == INTERRUPT the byte and its 9th bit come from the RX queue (UART_ReadByte drops the 9th bit)
+ */
+uint16 UART_ReceiveByte9(void);
+
+/***************************************** Multi-processor Communication Mode ********************************/
+/*
+ * Multi-drop bus: frames with the 9th bit set are addresses, frames with the 9th bit cleared are data.
+ * While a node is not addressed the hardware (MPCM) discards the data frames without setting RXC,
+ * so the node only spends CPU time on the address frames and on the data sent to it.
+ */
+
+/*
+ * Description : Enable the multi-processor communication mode on this node.
+ * arguments   : uint8 a_address : address of this node on the bus
+ * Return : None
+ * Note : the UART must be initialized with UART_9_BIT_DATA
+ */
+void UART_MPCM_init(uint8 a_address);
+
+/*
+ * Description : Send an address frame to select the node(s) receiving the next data bytes.
+ * 				 The data bytes are sent afterwards with UART_SendByte (9th bit = 0).
+ * arguments   : uint8 a_address : address of the node to be selected
+ * Return : None
+ */
+void UART_MPCM_SendAddress(uint8 a_address);
+
+/*
+ * Description : Receive a data byte addressed to this node, address frames are handled internally.
+ * arguments   : uint8 *ptr_data : pointer to the variable which will store the received byte
+ * Return : uint8 : status of the function [TRUE, FALSE]
+ * Note : this function is non-blocking function - using periodic polling method -
+ */
+uint8 UART_MPCM_ReceiveData(uint8 *ptr_data);
+
+/***************************************** Baud Rate Registers ***********************************************/
+/*
+ * Description : Reprogram the baud rate generator at runtime (used by the auto baud detection).
+ * arguments   : uint16 a_ubrr : value of the UBRR register
+ * 				 uint8 a_doubleSpeed : [TRUE (U2X = 1), FALSE (U2X = 0)]
+ * Return : None
+ * Note : it waits until UDR is empty, not for the shift register (TXC): call it while the line is idle
+ */
+void UART_SetUBRR(uint16 a_ubrr, uint8 a_doubleSpeed);
+
+/***************************************** Line Health Counters **********************************************/
+/*
+ * Description : Take a consistent snapshot of the line-health counters.
+ * arguments   : UART_StatsType *a_stats_ptr : pointer to the structure which will store the counters
+ * Return : None
+ */
+void UART_GetStats(UART_StatsType *a_stats_ptr);
+
+/*
+ * Description : Reset all line-health counters to zero.
+ */
+void UART_ClearStats(void);
+
+/***************************************** Buffered Send/Receive - MODE == INTERRUPT -************************/
+/*
+ * Description : Queue a byte in the TX buffer, the UDRE interrupt sends it in the background.
+ * arguments   : uint8 a_data : byte to be sent
+ * Return : uint8 : status of the function [TRUE, FALSE (TX buffer is full)]
+ * Note : this function is non-blocking, available only when MODE == INTERRUPT in UART_config.h
+ */
+uint8 UART_WriteByte(uint8 a_data);
+
+/*
+ * Description : Take the oldest byte received by the RXC interrupt out of the RX buffer.
+ * arguments   : uint8 *ptr_data : pointer to the variable which will store the received byte
+ * Return : uint8 : status of the function [TRUE, FALSE (RX buffer is empty)]
+ * Note : this function is non-blocking, available only when MODE == INTERRUPT in UART_config.h
+ */
+uint8 UART_ReadByte(uint8 *ptr_data);
+
+/*
+ * Description : Restart a transmission paused by CTS (FLOW_CONTROL == FLOW_CONTROL_RTS_CTS), the bytes of
+ * 				 the TX queue and of the UDRE call back (UART_SendBufferAsync).
+ * 				 The CTS edge interrupt (UART_CTS_INT), every UART_WriteByte and the blocking send functions
+ * 				 call it, the application only needs it with UART_CTS_INT_NONE and no new bytes queued.
+ * Return : None
+ */
+void UART_TX_Resume(void);
+
+/*
+ * Description : Get the number of free places in the TX buffer.
+ * Return : uint8 : number of bytes that can be queued without blocking
+ */
+uint8 UART_GetTxFree(void);
+
+/*
+ * Description : Get the number of received bytes waiting in the RX buffer.
+ * Return : uint8 : number of bytes that can be read without blocking
+ */
+uint8 UART_GetRxAvailable(void);
+
 #endif /* UART_H_ */
\ No newline at end of file
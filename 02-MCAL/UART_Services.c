@@ -11,90 +11,143 @@
  *******************************************************************************/
 #include "UART_Services.h"
 
-static uint8 *Send_Str = NULL_PTR;
+#include "FORMAT.h"
+#include "ICU.h"
+#include "QUEUE.h"
+#include "TIMER.h" // for the system tick
+#include "UART_config.h" // for MODE
+
+#include "SETTINGS.h" // for F_CPU
+#include <util/delay_basic.h>
+
+/* Frame protocol bytes */
+#define UART_FRAME_SOF 		0x7E
+#define UART_FRAME_DATA 	0x01
+#define UART_FRAME_DATA_FIRST 	0x02 /* DATA frame sent before the first ACK since reset: restarts the sequence */
+#define UART_FRAME_ACK 		0x06
+#define UART_FRAME_NAK 		0x15
+
+/* Falling edges of the sync character: start bit, bit 1, bit 3, bit 5 and bit 7 */
+#define AUTOBAUD_EDGES 		5
+
 static uint8 *Receive_str = NULL_PTR;
 
-static uint8 Stack[STACK_SIZE];
-static uint8 SP = 0;
+typedef struct
+{
+	const uint8 *data;
+	uint8 length;
+	void (*callBack)(void);
+} UART_TxDescriptorType;
+
+/* (pointer, length) descriptors, produced by UART_SendBufferAsync and consumed by the UDRE ISR */
+QUEUE_DEFINE(UART_TxDescQueue, UART_TxDescriptorType, UART_TX_QUEUE_SIZE)
+static uint8 TxQueue_Index = 0; // next byte of the descriptor at the tail (ISR only)
+
+static uint8 Frame_TxSeq = 0;			 // sequence number of the next DATA frame to be sent
+static boolean Frame_TxSynced = FALSE;	 // a DATA frame has been acknowledged since the reset
+static uint8 Frame_RxLastSeq = 0;		 // sequence number of the last accepted DATA frame
+static uint8 Frame_RxLastType = 0;		 // UART_FRAME_DATA or UART_FRAME_DATA_FIRST
+static uint16 Frame_RxLastCrc = 0;		 // CRC of the last accepted DATA frame
+static uint16 Frame_RxCrc = 0;			 // CRC of the last frame received by Frame_Receive
+static boolean Frame_RxLastSeqValid = FALSE; // no DATA frame has been accepted yet
+
+static volatile uint16 AutoBaud_Captures[AUTOBAUD_EDGES]; // Timer1 value at each falling edge
+static volatile uint8 AutoBaud_EdgeCount = 0;
 
 /*************************************************************************************************************
  *   										Functions Definitions										 	 *
  *************************************************************************************************************/
 
-Stack_Status_Type UART_PUSH(uint8 a_data)
+/**********************************************************************************************
+ * 										 	Send Functions									  *
+ **********************************************************************************************/
+/*************************** ISR for UART Data Register Empty Interrupt ***************************/
+static void TX_UDRE_INT(void)
 {
-	Stack_Status_Type Status;
-	if (SP == STACK_SIZE)
+	const volatile UART_TxDescriptorType *descriptor = UART_TxDescQueue_Peek();
+	void (*callBack)(void);
+
+	if (descriptor == NULL_PTR)
 	{
-		Status = STACK_FULL;
+		UART_UDRE_InterruptDisable(); // all buffers are sent
+		return;
 	}
-	else
+
+	UART_SendByteNoBlock(descriptor->data[TxQueue_Index]);
+	TxQueue_Index++;
+
+	if (TxQueue_Index == descriptor->length)
 	{
-		Stack[SP] = a_data;
-		SP++;
-		Status = DONE;
+		TxQueue_Index = 0;
+		callBack = descriptor->callBack;
+		UART_TxDescQueue_Drop(); // the descriptor can be reused from now on
+
+		if (callBack != NULL_PTR)
+		{
+			callBack();
+		}
 	}
-	return Status;
 }
 
-Stack_Status_Type UART_POP(uint8 *Ptr_data)
+void UART_SendString(const uint8 *Str)
 {
-	Stack_Status_Type Status;
-	if (SP == 0)
-	{
-		Status = STACK_EMPTY;
-	}
-	else
+	uint16 i = 0;
+	while (Str[i] != '\0')
 	{
-		SP--;
-		*Ptr_data = Stack[SP];
-		Status = DONE;
+		UART_SendByte(Str[i]);
+		i++;
 	}
-	return Status;
 }
 
-/**********************************************************************************************
- * 										 	Send Functions									  *
- **********************************************************************************************/
-/*************************** ISR for UART Transmit Complete Interrupt ***************************/
-static void TX_INT(void)
+void UART_SendString_interrupt(uint8 *str)
 {
-	static uint8 i = 1;
-	if (Send_Str[i] != '\0')
+	uint16 length = 0;
+	uint8 chunk;
+
+	while (str[length] != '\0')
 	{
-		UART_SendByteNoBlock(Send_Str[i]);
-		i++;
+		length++;
 	}
-	else
+
+	// a descriptor holds at most 255 bytes, longer strings are queued in chunks
+	while (length != 0)
 	{
-		i = 1;
-		UART_TX_InterruptDisable();
+		chunk = (length > 0xFF) ? 0xFF : (uint8)length;
+
+		// wait only if all the descriptors are in use
+		while (UART_SendBufferAsync(str, chunk, NULL_PTR) == FALSE)
+			;
+		str += chunk;
+		length -= chunk;
 	}
 }
 
-void UART_SendString(const uint8 *Str)
+uint8 UART_SendBufferAsync(const uint8 *a_data, uint8 a_length, void (*a_callBack)(void))
 {
-	uint8 i = 0;
-	while (Str[i] != '\0')
+	UART_TxDescriptorType descriptor;
+
+	descriptor.data = a_data;
+	descriptor.length = a_length;
+	descriptor.callBack = a_callBack;
+
+	if (a_length == 0 || UART_TxDescQueue_Push(descriptor) == FALSE)
 	{
-		UART_SendByte(Str[i]);
-		i++;
+		return FALSE;
 	}
+
+	// Set Call Back function for UDRE interrupt, then (re)start the transmission
+	UART_UDRE_SetCallBack(TX_UDRE_INT);
+	UART_UDRE_InterruptEnable();
+	return TRUE;
 }
 
-void UART_SendString_interrupt(uint8 *str)
+void UART_printf(const char *format, ...)
 {
-	// save the string in global pointer
-	Send_Str = str;
-
-	// send first byte
-	UART_SendByteNoBlock(str[0]);
-
-	// Set Call Back function for TXC interrupt
-	UART_TX_SetCallBack(TX_INT);
+	va_list args;
 
-	// Enable Transmit complete interrupt
-	UART_TX_InterruptEnable();
+	va_start(args, format);
+	FORMAT_vprintf(UART_SendByte, format, args); // in MODE == INTERRUPT the bytes go to the TX queue
+	va_end(args);
 }
 
 void UART_SendFourBytes(uint32 a_data)
@@ -115,6 +168,20 @@ void UART_SendFourBytes(uint32 a_data)
 static void RX_INT(void) // receive until '#'
 {
 	static uint8 i = 0;
+#if (MODE == INTERRUPT)
+	// the ISR already moved the byte to the RX queue, the RX interrupt must stay enabled to fill it
+	while (UART_ReadByte(&Receive_str[i]) == TRUE)
+	{
+		if (Receive_str[i] == '#')
+		{
+			Receive_str[i] = '\0';
+			i = 0;
+			UART_RX_SetCallBack(NULL_PTR);
+			return;
+		}
+		i++;
+	}
+#else
 	Receive_str[i] = UART_ReceiveByteNoBlock();
 	if (Receive_str[i] == '#')
 	{
@@ -126,6 +193,7 @@ static void RX_INT(void) // receive until '#'
 	{
 		i++;
 	}
+#endif
 }
 
 void UART_ReceiveString(uint8 *Str) // receive until '#'
@@ -167,4 +235,380 @@ void UART_ReceiveFourBytes(uint32 *a_data)
 		*a_data |= (uint32)(UART_ReceiveByte() << (i * 8));
 		//_delay_ms(10);
 	}
-}
\ No newline at end of file
+}
+
+/*
+ * Time left from a_timeout_ms since a_start (0 when it is over),
+ * each byte of a multi-byte receive gets only the remaining time of the whole call.
+ */
+static uint16 UART_RemainingTime(uint32 a_start, uint16 a_timeout_ms)
+{
+	uint32 elapsed = Timer2_Tick_getMs() - a_start;
+	return (elapsed >= a_timeout_ms) ? 0 : (uint16)(a_timeout_ms - elapsed);
+}
+
+UART_StatusType UART_ReceiveStringTimeout(uint8 *Str, uint8 a_maxLength, uint16 a_timeout_ms)
+{
+	uint8 i = 0;
+	uint32 start = Timer2_Tick_getMs();
+
+	if (a_maxLength == 0)
+	{
+		return UART_OVERFLOW;
+	}
+
+	while (1)
+	{
+		if (i == a_maxLength - 1)
+		{
+			Str[i] = '\0'; // no '#' within the buffer, the rest of the string is left in the UART
+			return UART_OVERFLOW;
+		}
+		if (UART_ReceiveByteTimeout(&Str[i], UART_RemainingTime(start, a_timeout_ms)) != UART_OK)
+		{
+			Str[i] = '\0'; // keep the partial string printable
+			return UART_TIMEOUT;
+		}
+		if (Str[i] == '#')
+		{
+			Str[i] = '\0';
+			return UART_OK;
+		}
+		i++;
+	}
+}
+
+UART_StatusType UART_ReceiveFourBytesTimeout(uint32 *a_data, uint16 a_timeout_ms)
+{
+	uint8 i;
+	uint8 byte;
+	uint32 value = 0;
+	uint32 start = Timer2_Tick_getMs();
+
+	for (i = 0; i < 4; i++)
+	{
+		if (UART_ReceiveByteTimeout(&byte, UART_RemainingTime(start, a_timeout_ms)) != UART_OK)
+		{
+			return UART_TIMEOUT; // *a_data is left unchanged
+		}
+		value |= (uint32)byte << (i * 8);
+	}
+	*a_data = value;
+	return UART_OK;
+}
+
+/**********************************************************************************************
+ * 										 	Frame Functions									  *
+ **********************************************************************************************/
+static uint16 Frame_CRC16_Update(uint16 crc, uint8 a_data)
+{
+	uint8 i;
+	crc ^= (uint16)a_data << 8;
+	for (i = 0; i < 8; i++)
+	{
+		if (crc & 0x8000)
+		{
+			crc = (crc << 1) ^ 0x1021;
+		}
+		else
+		{
+			crc <<= 1;
+		}
+	}
+	return crc;
+}
+
+/*
+ * Wait for one byte at most a_timeout_ms milliseconds (a_timeout_ms = 0 -> wait forever).
+ * Return TRUE if a byte is received.
+ */
+static boolean Frame_ReceiveByte(uint8 *ptr_data, uint16 a_timeout_ms)
+{
+	if (a_timeout_ms == 0)
+	{
+		*ptr_data = UART_ReceiveByte();
+		return TRUE;
+	}
+	return (UART_ReceiveByteTimeout(ptr_data, a_timeout_ms) == UART_OK) ? TRUE : FALSE;
+}
+
+static void Frame_Send(uint8 a_type, uint8 a_seq, const uint8 *a_data, uint8 a_length)
+{
+	uint8 i;
+	uint16 crc = 0xFFFF;
+
+	UART_SendByte(UART_FRAME_SOF);
+
+	UART_SendByte(a_type);
+	crc = Frame_CRC16_Update(crc, a_type);
+	UART_SendByte(a_seq);
+	crc = Frame_CRC16_Update(crc, a_seq);
+	UART_SendByte(a_length);
+	crc = Frame_CRC16_Update(crc, a_length);
+
+	for (i = 0; i < a_length; i++)
+	{
+		UART_SendByte(a_data[i]);
+		crc = Frame_CRC16_Update(crc, a_data[i]);
+	}
+
+	UART_SendByte((uint8)(crc >> 8));
+	UART_SendByte((uint8)crc);
+}
+
+/*
+ * Receive one frame, the start of the frame is awaited a_timeout_ms (0 -> forever)
+ * and the rest of the frame must follow within UART_FRAME_BYTE_TIMEOUT_MS per byte.
+ */
+static UART_FrameStatus_Type Frame_Receive(uint8 *a_type, uint8 *a_seq, uint8 *a_data, uint8 *a_length,
+										   uint8 a_maxLength, uint16 a_timeout_ms)
+{
+	uint8 i;
+	uint8 byte = 0;
+	uint16 crc = 0xFFFF;
+	uint16 receivedCrc;
+
+	/* Skip everything until the start of frame */
+	do
+	{
+		if (Frame_ReceiveByte(&byte, a_timeout_ms) == FALSE)
+		{
+			return UART_FRAME_TIMEOUT;
+		}
+	} while (byte != UART_FRAME_SOF);
+
+	if (Frame_ReceiveByte(a_type, UART_FRAME_BYTE_TIMEOUT_MS) == FALSE)
+		return UART_FRAME_TIMEOUT;
+	crc = Frame_CRC16_Update(crc, *a_type);
+	if (Frame_ReceiveByte(a_seq, UART_FRAME_BYTE_TIMEOUT_MS) == FALSE)
+		return UART_FRAME_TIMEOUT;
+	crc = Frame_CRC16_Update(crc, *a_seq);
+	if (Frame_ReceiveByte(a_length, UART_FRAME_BYTE_TIMEOUT_MS) == FALSE)
+		return UART_FRAME_TIMEOUT;
+	crc = Frame_CRC16_Update(crc, *a_length);
+
+	if (*a_length > a_maxLength)
+	{
+		return UART_FRAME_TOO_LONG;
+	}
+
+	for (i = 0; i < *a_length; i++)
+	{
+		if (Frame_ReceiveByte(&a_data[i], UART_FRAME_BYTE_TIMEOUT_MS) == FALSE)
+			return UART_FRAME_TIMEOUT;
+		crc = Frame_CRC16_Update(crc, a_data[i]);
+	}
+
+	if (Frame_ReceiveByte(&byte, UART_FRAME_BYTE_TIMEOUT_MS) == FALSE)
+		return UART_FRAME_TIMEOUT;
+	receivedCrc = (uint16)byte << 8;
+	if (Frame_ReceiveByte(&byte, UART_FRAME_BYTE_TIMEOUT_MS) == FALSE)
+		return UART_FRAME_TIMEOUT;
+	receivedCrc |= byte;
+
+	Frame_RxCrc = crc;
+	return (receivedCrc == crc) ? UART_FRAME_OK : UART_FRAME_CRC_ERROR;
+}
+
+/*
+ * The ACK of the last accepted DATA frame (just received by Frame_Receive) was lost and the sender
+ * retransmitted it. A DATA_FIRST frame comes from a sender that was reset: it only repeats a DATA_FIRST
+ * frame with the same content (CRC), the same SEQ alone may be the restarted sequence after another reset.
+ */
+static boolean Frame_IsDuplicate(uint8 a_type, uint8 a_seq)
+{
+	if (Frame_RxLastSeqValid == FALSE || a_seq != Frame_RxLastSeq)
+	{
+		return FALSE;
+	}
+	if (a_type == UART_FRAME_DATA)
+	{
+		return TRUE;
+	}
+	return (Frame_RxLastType == UART_FRAME_DATA_FIRST && Frame_RxCrc == Frame_RxLastCrc) ? TRUE : FALSE;
+}
+
+UART_FrameStatus_Type UART_SendFrame(const uint8 *a_data, uint8 a_length)
+{
+	uint8 attempt;
+	uint8 type, seq, length;
+	uint8 payload[UART_FRAME_MAX_PAYLOAD]; // DATA frame of the other device received instead of the ACK
+	/* until the receiver acknowledges a frame it may still hold the sequence number from before our reset */
+	uint8 dataType = (Frame_TxSynced == TRUE) ? UART_FRAME_DATA : UART_FRAME_DATA_FIRST;
+
+	if (a_length > UART_FRAME_MAX_PAYLOAD)
+	{
+		return UART_FRAME_TOO_LONG;
+	}
+
+	for (attempt = 0; attempt <= UART_FRAME_MAX_RETRIES; attempt++)
+	{
+		Frame_Send(dataType, Frame_TxSeq, a_data, a_length);
+
+		/* anything but the ACK is ignored and the frame retransmitted */
+		if (Frame_Receive(&type, &seq, payload, &length, UART_FRAME_MAX_PAYLOAD, UART_FRAME_ACK_TIMEOUT_MS) ==
+			UART_FRAME_OK)
+		{
+			if (type == UART_FRAME_ACK && seq == Frame_TxSeq)
+			{
+				Frame_TxSeq++;
+				Frame_TxSynced = TRUE;
+				return UART_FRAME_OK;
+			}
+			if ((type == UART_FRAME_DATA || type == UART_FRAME_DATA_FIRST) && Frame_IsDuplicate(type, seq) == TRUE)
+			{
+				/* our ACK of its last frame was lost, it waits for it instead of acknowledging ours */
+				Frame_Send(UART_FRAME_ACK, seq, NULL_PTR, 0);
+			}
+		}
+	}
+	return UART_FRAME_NO_ACK;
+}
+
+UART_FrameStatus_Type UART_ReceiveFrame(uint8 *a_data, uint8 *a_length, uint8 a_maxLength)
+{
+	return UART_ReceiveFrameTimeout(a_data, a_length, a_maxLength, 0);
+}
+
+UART_FrameStatus_Type UART_ReceiveFrameTimeout(uint8 *a_data, uint8 *a_length, uint8 a_maxLength,
+												uint16 a_timeout_ms)
+{
+	uint8 type, seq;
+	UART_FrameStatus_Type status;
+	uint16 remaining = 0; // 0 -> Frame_Receive waits forever
+	uint32 start = Timer2_Tick_getMs();
+
+	while (1)
+	{
+		if (a_timeout_ms != 0)
+		{
+			remaining = UART_RemainingTime(start, a_timeout_ms);
+			if (remaining == 0)
+			{
+				return UART_FRAME_TIMEOUT;
+			}
+		}
+		type = 0; // only set once the start of frame is received
+		status = Frame_Receive(&type, &seq, a_data, a_length, a_maxLength, remaining);
+
+		if (status == UART_FRAME_TIMEOUT && type == 0)
+		{
+			continue; // nothing received, the time left is checked above
+		}
+		if (status != UART_FRAME_OK)
+		{
+			/* ask for a retransmission, the sequence number may be corrupted so send the expected one */
+			Frame_Send(UART_FRAME_NAK, (uint8)(Frame_RxLastSeq + 1), NULL_PTR, 0);
+			continue;
+		}
+
+		if (type != UART_FRAME_DATA && type != UART_FRAME_DATA_FIRST)
+		{
+			continue; // late ACK/NAK
+		}
+
+		Frame_Send(UART_FRAME_ACK, seq, NULL_PTR, 0);
+
+		if (Frame_IsDuplicate(type, seq) == TRUE)
+		{
+			continue;
+		}
+
+		Frame_RxLastSeq = seq;
+		Frame_RxLastType = type;
+		Frame_RxLastCrc = Frame_RxCrc;
+		Frame_RxLastSeqValid = TRUE;
+		return UART_FRAME_OK;
+	}
+}
+
+/**********************************************************************************************
+ * 										 	Auto Baud Functions								  *
+ **********************************************************************************************/
+/*************************** ISR for ICU edge capture ***************************/
+static void AutoBaud_ICU_ISR(void)
+{
+	if (AutoBaud_EdgeCount < AUTOBAUD_EDGES)
+	{
+		AutoBaud_Captures[AutoBaud_EdgeCount] = ICU_getInputCaptureValue();
+		AutoBaud_EdgeCount++;
+	}
+}
+
+/*
+ * Every gap between two falling edges of the sync character is two bit times,
+ * reject the measurement if one of them is more than 25 % away from span / 4.
+ */
+static boolean AutoBaud_IsValid(uint16 span)
+{
+	uint8 i;
+	uint16 gap;
+	uint16 expected = span / 4;
+	uint16 tolerance = expected / 4;
+
+	for (i = 1; i < AUTOBAUD_EDGES; i++)
+	{
+		gap = AutoBaud_Captures[i] - AutoBaud_Captures[i - 1];
+		if (gap < expected - tolerance || gap > expected + tolerance)
+		{
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+uint32 UART_AutoBaud(void)
+{
+	ICU_ConfigType AutoBaud_Config = {F_CPU_CLOCK, FALLING};
+	uint16 span; // 8 bit times in CPU cycles (the timer runs at F_CPU)
+	uint32 n_normal, n_double;
+	uint32 error_normal, error_double;
+	uint8 dummy;
+
+	ICU_setCallBack(AutoBaud_ICU_ISR);
+
+	do
+	{
+		AutoBaud_EdgeCount = 0;
+		ICU_init(&AutoBaud_Config);
+		while (AutoBaud_EdgeCount < AUTOBAUD_EDGES)
+			;
+		ICU_deInit(); // also removes the call back
+		ICU_setCallBack(AutoBaud_ICU_ISR);
+
+		span = AutoBaud_Captures[AUTOBAUD_EDGES - 1] - AutoBaud_Captures[0];
+	} while (AutoBaud_IsValid(span) == FALSE);
+
+	ICU_setCallBack(NULL_PTR);
+
+	/*
+	 * The last edge is the start of bit 7, bit 7 and the stop bit are still on the line:
+	 * wait 2 measured bit times (span / 4 cycles, 4 cycles per loop) so the sync character is
+	 * received completely with the old setting before UBRR changes, then it is flushed below.
+	 */
+	_delay_loop_2((span / 16) + 1);
+
+	/*
+	 * bit time = span / 8 = divider * (UBRR + 1)  ->  UBRR + 1 = span / (8 * divider)
+	 * divider = 16 (U2X = 0) or 8 (U2X = 1), each rounded to the nearest value
+	 */
+	n_normal = ((uint32)span + 64) / 128;
+	n_double = ((uint32)span + 32) / 64;
+	error_normal = (n_normal * 128 > span) ? (n_normal * 128 - span) : (span - n_normal * 128);
+	error_double = (n_double * 64 > span) ? (n_double * 64 - span) : (span - n_double * 64);
+
+	if (n_normal != 0 && error_normal <= error_double)
+	{
+		UART_SetUBRR((uint16)(n_normal - 1), FALSE);
+	}
+	else
+	{
+		UART_SetUBRR((n_double != 0) ? (uint16)(n_double - 1) : 0, TRUE);
+	}
+
+	/* the sync character itself was received with the old setting, drop it */
+	while (UART_ReceiveByteCheck(&dummy) == TRUE)
+		;
+
+	return (F_CPU * 8UL) / span;
+}
@@ -18,36 +18,48 @@
 /*************************************************************************************************************
  *   									      Static configurations										 	 *
  * ***********************************************************************************************************/
-#define STACK_SIZE 10
+/* number of (pointer, length) descriptors that can wait for the UDRE interrupt, power of two (<= 128) */
+#define UART_TX_QUEUE_SIZE 			4
+
+/************************************** Frame protocol ******************************************************
+ * | SOF (0x7E) | TYPE | SEQ | LEN | PAYLOAD (LEN bytes) | CRC16 high | CRC16 low |
+ * CRC-16/CCITT (poly 0x1021, init 0xFFFF) is calculated over TYPE, SEQ, LEN and PAYLOAD.
+ * Every DATA frame is answered by an ACK (or a NAK) frame carrying the same SEQ.
+ * After a reset the sender uses the DATA_FIRST type until its first frame is acknowledged,
+ * so the receiver accepts the restarted SEQ instead of dropping it as a duplicate: a DATA_FIRST frame
+ * is only dropped if it repeats the last accepted DATA_FIRST frame (same SEQ and CRC).
+ * The timeouts use the Timer2 system tick (Timer2_Tick_init must be called).
+ ************************************************************************************************************/
+#define UART_FRAME_MAX_PAYLOAD 		16	/* maximum number of payload bytes in one frame */
+#define UART_FRAME_ACK_TIMEOUT_MS 	50	/* time to wait for the ACK before retransmitting */
+#define UART_FRAME_BYTE_TIMEOUT_MS 	10	/* maximum gap between two bytes of the same frame */
+#define UART_FRAME_MAX_RETRIES 		3	/* number of retransmissions before giving up */
+
+/************************************** Auto baud detection *************************************************
+ * The UART RX pin (PD0) must also be wired to the Timer1 input capture pin ICP1 (PD6).
+ * The other device sends UART_AUTOBAUD_SYNC_CHAR ('U' = 0x55) which gives 5 falling edges,
+ * two bit times apart, the first to the last falling edge is 8 bit times long.
+ * Every edge is timed by the ICU interrupt, so two bit times must be longer than the
+ * ICU interrupt latency (about 60 cycles) -> detectable rates up to about F_CPU / 30.
+ ************************************************************************************************************/
+#define UART_AUTOBAUD_SYNC_CHAR 	0x55
 
 /*************************************************************************************************************
  *   										User defined data types										 	 *
  * ***********************************************************************************************************/
 typedef enum
 {
-	STACK_EMPTY, // 0
-	STACK_FULL,	 // 1
-	DONE		 // 2
-} Stack_Status_Type;
+	UART_FRAME_OK,		  // 0
+	UART_FRAME_TIMEOUT,	  // 1 : the frame stopped in the middle (dropped byte)
+	UART_FRAME_CRC_ERROR, // 2 : the frame was corrupted
+	UART_FRAME_TOO_LONG,  // 3 : the payload does not fit in the receive buffer
+	UART_FRAME_NO_ACK	  // 4 : the other device did not acknowledge the frame after all retries
+} UART_FrameStatus_Type;
 
 /*************************************************************************************************************
  *   										Functions Prototypes										 	 *
  * ***********************************************************************************************************/
 
-/*
- * Description : Push the required data to the stack.
- * arguments   : uint8 a_data : data to be pushed
- * Return      : Stack_Status_Type : status of the stack
- */
-Stack_Status_Type UART_PUSH(uint8 a_data);
-
-/*
- * Description : Pop the required data from the stack.
- * arguments   : uint8 *Ptr_data : pointer to the variable to store the popped data
- * Return      : Stack_Status_Type : status of the stack
- */
-Stack_Status_Type UART_POP(uint8 *Ptr_data);
-
 /*
  * Description : Send the required string through UART to the other UART device.
  * arguments   : const uint8 *Str : pointer to the string to be sent
@@ -61,9 +73,31 @@ void UART_SendString(const uint8 *Str);
  * arguments   : uint8 *Str : pointer to the string to be sent
  * Return      : None
  * Note        : The string should be ended with '#' to be received correctly
+ * 				 the string is queued with UART_SendBufferAsync (in chunks of 255 bytes when longer),
+ * 				 it must stay valid until it is sent
  */
 void UART_SendString_interrupt(uint8 *str);
 
+/*
+ * Description : Queue a buffer to be sent from the UDRE interrupt without copying it.
+ * 				 Queued buffers are sent back-to-back in order, then the call back of each buffer is called
+ * 				 (from the ISR) as soon as its last byte is written to UDR, so the buffer can be reused.
+ * arguments   : const uint8 *a_data : pointer to the buffer, it must stay valid until the call back
+ * 				 uint8 a_length : number of bytes to be sent (1 .. 255)
+ * 				 void (*a_callBack)(void) : completion call back (NULL_PTR for none)
+ * Return      : uint8 : status of the function [TRUE, FALSE (the descriptor queue is full or a_length = 0)]
+ * Note        : this function is non-blocking function - using UDRE interrupt -
+ */
+uint8 UART_SendBufferAsync(const uint8 *a_data, uint8 a_length, void (*a_callBack)(void));
+
+/*
+ * Description : Send a formatted string through UART, e.g. UART_printf("rpm=%u err=%04x\r\n", rpm, err)
+ * arguments   : const char *format : format string followed by its arguments (see FORMAT.h, no float)
+ * Return      : None
+ * Note        : in MODE == INTERRUPT the characters are queued, the function waits only while the TX queue is full
+ */
+void UART_printf(const char *format, ...);
+
 /*
  * Description : Send Four bytes through UART to the other UART device. (by sending each byte separately)
  * arguments   : uint32 a_data : data to be sent
@@ -93,4 +127,68 @@ void UART_ReceiveString_interrupt(uint8 *str);
  * Return      : None
  */
 void UART_ReceiveFourBytes(uint32 *a_data);
+
+/*
+ * Description : Receive a string until the '#' symbol, giving up after a timeout.
+ * arguments   : uint8 *Str : pointer to the string to store the received string
+ * 				 uint8 a_maxLength : size of the buffer, the '\0' included
+ * 				 uint16 a_timeout_ms : maximum time for the whole string in milliseconds
+ * Return      : UART_StatusType : [UART_OK, UART_TIMEOUT (Str holds the part received so far),
+ * 				 UART_OVERFLOW (a_maxLength - 1 bytes received without '#', Str holds them)]
+ * Note        : the timeout is measured with the Timer2 system tick (Timer2_Tick_init must be called)
+ */
+UART_StatusType UART_ReceiveStringTimeout(uint8 *Str, uint8 a_maxLength, uint16 a_timeout_ms);
+
+/*
+ * Description : Receive Four bytes, giving up after a timeout.
+ * arguments   : uint32 *a_data : pointer to the variable to store the received data
+ * 				 uint16 a_timeout_ms : maximum time for the four bytes in milliseconds
+ * Return      : UART_StatusType : [UART_OK, UART_TIMEOUT (*a_data is not changed)]
+ * Note        : the timeout is measured with the Timer2 system tick (Timer2_Tick_init must be called)
+ */
+UART_StatusType UART_ReceiveFourBytesTimeout(uint32 *a_data, uint16 a_timeout_ms);
+
+/*
+ * Description : Send a framed, CRC protected block and wait for its acknowledgement.
+ * 				 The frame is retransmitted on NAK or ACK timeout up to UART_FRAME_MAX_RETRIES times.
+ * arguments   : const uint8 *a_data : pointer to the payload
+ * 				 uint8 a_length : number of payload bytes (up to UART_FRAME_MAX_PAYLOAD)
+ * Return      : UART_FrameStatus_Type : UART_FRAME_OK when the other device acknowledged the frame
+ */
+UART_FrameStatus_Type UART_SendFrame(const uint8 *a_data, uint8 a_length);
+
+/*
+ * Description : Receive the next framed block, acknowledge it and drop retransmitted duplicates.
+ * 				 Corrupted or incomplete frames are answered with NAK and the function keeps waiting.
+ * arguments   : uint8 *a_data : pointer to the buffer to store the payload
+ * 				 uint8 *a_length : pointer to the variable to store the number of received bytes
+ * 				 uint8 a_maxLength : size of the buffer
+ * Return      : UART_FrameStatus_Type : UART_FRAME_OK
+ * Note        : this function is blocking function until a valid frame is received
+ */
+UART_FrameStatus_Type UART_ReceiveFrame(uint8 *a_data, uint8 *a_length, uint8 a_maxLength);
+
+/*
+ * Description : Same as UART_ReceiveFrame, giving up when no valid frame is received within a_timeout_ms.
+ * arguments   : uint8 *a_data : pointer to the buffer to store the payload
+ * 				 uint8 *a_length : pointer to the variable to store the number of received bytes
+ * 				 uint8 a_maxLength : size of the buffer
+ * 				 uint16 a_timeout_ms : maximum waiting time in milliseconds (0 -> forever)
+ * Return      : UART_FrameStatus_Type : [UART_FRAME_OK, UART_FRAME_TIMEOUT]
+ * Note        : a frame that started before the deadline is still received completely
+ */
+UART_FrameStatus_Type UART_ReceiveFrameTimeout(uint8 *a_data, uint8 *a_length, uint8 a_maxLength,
+												uint16 a_timeout_ms);
+
+/*
+ * Description : Measure the bit time of UART_AUTOBAUD_SYNC_CHAR sent by the other device on the RX pin
+ * 				 with the Timer1 input capture unit, then program the closest UBRR and U2X setting.
+ * 				 The bit time is measured in CPU cycles, so the result follows the real clock of this
+ * 				 board even when it drifts away from F_CPU (internal RC oscillator).
+ * arguments   : None
+ * Return      : uint32 : the measured baud rate (in units of the nominal F_CPU)
+ * Note        : this function is blocking until a valid sync character is received,
+ * 				 it uses Timer1 and needs the global interrupts to be enabled.
+ */
+uint32 UART_AutoBaud(void);
 #endif /* UART_SERVICES_H_ */
\ No newline at end of file
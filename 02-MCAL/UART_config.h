@@ -14,7 +14,6 @@
 #include "SETTINGS.h" // for F_CPU
 
 /******************* UART configuration *********************************/
-#define SPEED_MODE 			DOUBLE_SPEED
 //#define CPU_F 				_16_MHZ		// not used
 //#define BUAD_RATE 			BAUD_9600 	// not used
 #define SYNCH_MODE 			ASYNCH
@@ -25,13 +24,56 @@
 /******************* Interrupt configuration *********************************/
 #define MODE 				POLLING
 
-#define POLLING 				0
-#define INTERRUPT 				1
+#define POLLING 				0 /* blocking byte API, busy waiting on UDRE/RXC */
+#define INTERRUPT 				1 /* UDRE driven TX queue and RXC driven RX queue */
 
-/******************** speed mode *************************/
-#define NORMAL_SPEED 			0
-#define DOUBLE_SPEED 			1
-#define TOTAL_SPEED_MODE 		2 // unused
+/******************* Buffered mode configuration (MODE == INTERRUPT) *********/
+/* sizes must be a power of two (2 .. 128) to index the queues with a mask */
+#define UART_TX_BUFFER_SIZE 	32
+#define UART_RX_BUFFER_SIZE 	32
+
+/******************* Flow control configuration (MODE == INTERRUPT) **********/
+/*
+ * RTS/CTS on GPIO pins, both active low:
+ * - RTS (output) is released (high) when the RX buffer reaches UART_RX_HIGH_WATER and driven low
+ *   again when it drains to UART_RX_LOW_WATER, the space above the high water mark absorbs
+ *   the bytes the other device has already started to send.
+ * - CTS (input, pulled up) high pauses the transmission before the next byte.
+ */
+#define FLOW_CONTROL 			FLOW_CONTROL_OFF
+
+#define FLOW_CONTROL_OFF 		0
+#define FLOW_CONTROL_RTS_CTS 	1
+
+#define UART_RTS_PORT_ID 		PORTD_ID
+#define UART_RTS_PIN_ID 		PIN4_ID
+#define UART_CTS_PORT_ID 		PORTD_ID
+#define UART_CTS_PIN_ID 		PIN2_ID
+
+/*
+ * External interrupt on the CTS pin: its falling edge restarts a transmission paused by CTS.
+ * UART_CTS_INT_NONE allows any CTS pin, the transmission then restarts only on the next
+ * UART_WriteByte / UART_TX_Resume (the blocking send functions call it while they wait).
+ */
+#define UART_CTS_INT 			UART_CTS_INT0
+
+#define UART_CTS_INT0 			0 /* PD2 */
+#define UART_CTS_INT1 			1 /* PD3 */
+#define UART_CTS_INT2 			2 /* PB2 */
+#define UART_CTS_INT_NONE 		3
+
+#define UART_RX_HIGH_WATER 		(UART_RX_BUFFER_SIZE - 8)
+#define UART_RX_LOW_WATER 		(UART_RX_BUFFER_SIZE / 4)
+
+/******************* Baud rate configuration *********************************/
+/*
+ * UBRR and the U2X (double speed) bit are selected at compile time for every UART_BaudRate,
+ * whichever speed mode gives the lower error with the F_CPU in SETTINGS.h.
+ * Baud rates with an error above UART_MAX_BAUD_ERROR are not compiled in and UART_init returns FALSE,
+ * the build fails if UART_APP_BAUD_RATE (the rate the applications configure) is one of them.
+ */
+#define UART_APP_BAUD_RATE 		9600UL
+#define UART_MAX_BAUD_ERROR 	20 /* in 0.1 % units (20 -> 2.0 %) */
 
 ///*******************parity mode*************************/
 //#define NO_PARITY 				0
@@ -49,6 +91,27 @@
 #define SYNCH 					0
 #define ASYNCH					1
 
+/******************* Synchronous mode configuration (SYNCH_MODE == SYNCH) ****/
+/*
+ * The master drives the clock on XCK (PB0) at F_CPU / (2 * (UBRR + 1)), up to F_CPU / 2,
+ * the slave takes it from its XCK input, up to F_CPU / 4 of the slave clock.
+ * Both devices must use the same clock polarity, the two boards of a link are built with
+ * a different role (e.g. -DUART_SYNCH_ROLE=UART_SYNCH_SLAVE for one of them).
+ */
+#ifndef UART_SYNCH_ROLE
+	#define UART_SYNCH_ROLE 	UART_SYNCH_MASTER
+#endif
+#define UART_CLOCK_POLARITY 	UART_TX_RISING_RX_FALLING
+
+#define UART_SYNCH_MASTER 		0 /* XCK output */
+#define UART_SYNCH_SLAVE 		1 /* XCK input */
+
+#define UART_TX_RISING_RX_FALLING 0 /* UCPOL = 0 : TXD changes on the rising edge, RXD is sampled on the falling edge */
+#define UART_TX_FALLING_RX_RISING 1 /* UCPOL = 1 : TXD changes on the falling edge, RXD is sampled on the rising edge */
+
+#define UART_XCK_PORT_ID 		PORTB_ID
+#define UART_XCK_PIN_ID 		PIN0_ID
+
 ///************ Number of stop bits**********************/
 //#define ONE_STOP_BIT 			1
 //#define TWO_STOP_BIT 			2
@@ -12,40 +12,92 @@
 
 #include "EEPROM.h"
 
+#include "I2C_REGISTRY.h"
 #include "TWI.h"
 
+/*
+ * the 8 blocks of 256 bytes answer at 8 consecutive addresses (A8 A9 A10 in the device address),
+ * resolved once by EEPROM_init from the registry (defaults: 0x50 .. 0x57)
+ */
+static TWI_DeviceType EEPROM_Blocks[8] = {
+	TWI_DEVICE(0x50, EEPROM_SCL_FREQUENCY), TWI_DEVICE(0x51, EEPROM_SCL_FREQUENCY),
+	TWI_DEVICE(0x52, EEPROM_SCL_FREQUENCY), TWI_DEVICE(0x53, EEPROM_SCL_FREQUENCY),
+	TWI_DEVICE(0x54, EEPROM_SCL_FREQUENCY), TWI_DEVICE(0x55, EEPROM_SCL_FREQUENCY),
+	TWI_DEVICE(0x56, EEPROM_SCL_FREQUENCY), TWI_DEVICE(0x57, EEPROM_SCL_FREQUENCY)};
+
+/* block of a memory location and its address byte (SLA+R/W) */
+#define EEPROM_BLOCK(u16address) 	(&EEPROM_Blocks[((u16address) & 0x0700) >> 8])
+#define EEPROM_SLA(block, mode) 	((uint8)((block)->address << 1) | (mode))
+
+/* the word address must stay valid while the TWI interrupt sends it */
+static uint8 EEPROM_asyncWordAddress;
+static volatile TWI_ResultType EEPROM_asyncResult = TWI_RESULT_OK;
+
+/* end of a failed access: a STOP frees the bus, a bus held by the EEPROM itself (timeout) needs the recovery */
+static ErrorStatus_t EEPROM_abort(void)
+{
+	if (TWI_getStatus() == TWI_TIMEOUT)
+	{
+		TWI_recoverBus();
+	}
+	else
+	{
+		TWI_stop();
+	}
+	return ERROR;
+}
+
 void EEPROM_init(void)
 {
 	/* set the configuration of the TWI module inside the MC */
-	TWI_configType TWI_EEPROM_Config = {FastMode_400Kb, TWI_Prescaler_1, TWI_GeneralCallRecognitionEnable_OFF, EEPROM_SLAVE_ADDRESS};
+	TWI_configType TWI_EEPROM_Config = {EEPROM_SCL_FREQUENCY, TWI_Prescaler_1, TWI_GeneralCallRecognitionEnable_OFF, EEPROM_SLAVE_ADDRESS};
+
+	const TWI_DeviceType *device;
+	uint8 i;
 
 	/* just initialize the I2C(TWI) module inside the MC */
 	TWI_init(&TWI_EEPROM_Config);
+
+	/* address and speed found on the bus, the defaults are kept if the EEPROM didn't answer */
+	I2C_REGISTRY_init();
+	device = I2C_REGISTRY_getDevice(I2C_REGISTRY_EEPROM);
+	if (device != NULL_PTR)
+	{
+		for (i = 0; i < 8; i++)
+		{
+			EEPROM_Blocks[i].address = device->address + i;
+			EEPROM_Blocks[i].twbr = device->twbr;
+			EEPROM_Blocks[i].twps = device->twps;
+		}
+	}
 }
 
 
 ErrorStatus_t EEPROM_writeByte(uint16 u16address, uint8 u8data)
 {
+	const TWI_DeviceType *block = EEPROM_BLOCK(u16address);
+	/* bit rate of the EEPROM */
+	TWI_select(block);
+
 	/* Send the Start Bit */
 	TWI_start();
 	if (TWI_getStatus() != TWI_START)
-		return ERROR;
+		return EEPROM_abort();
 
-	/* Send the device address, we need to get A8 A9 A10 address bits from the
-	 * memory location address and R/W=0 (write) */
-	TWI_writeByte((uint8)(EEPROM_DEVICE_ADDRESS | ((u16address & 0x0700) >> 7) | WRITEMODE));
+	/* Send the device address of the block (A8 A9 A10) and R/W=0 (write) */
+	TWI_writeByte(EEPROM_SLA(block, WRITEMODE));
 	if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
-		return ERROR;
+		return EEPROM_abort();
 
 	/* Send the required memory location address */
 	TWI_writeByte((uint8)(u16address));
 	if (TWI_getStatus() != TWI_MT_DATA_ACK)
-		return ERROR;
+		return EEPROM_abort();
 
 	/* write byte to eeprom */
 	TWI_writeByte(u8data);
 	if (TWI_getStatus() != TWI_MT_DATA_ACK)
-		return ERROR;
+		return EEPROM_abort();
 
 	/* Send the Stop Bit */
 	TWI_stop();
@@ -55,37 +107,39 @@ ErrorStatus_t EEPROM_writeByte(uint16 u16address, uint8 u8data)
 
 ErrorStatus_t EEPROM_readByte(uint16 u16address, uint8 *u8data)
 {
+	const TWI_DeviceType *block = EEPROM_BLOCK(u16address);
+	/* bit rate of the EEPROM */
+	TWI_select(block);
+
 	/* Send the Start Bit */
 	TWI_start();
 	if (TWI_getStatus() != TWI_START)
-		return ERROR;
+		return EEPROM_abort();
 
-	/* Send the device address, we need to get A8 A9 A10 address bits from the
-	 * memory location address and R/W=0 (write) */
-	TWI_writeByte((uint8)(EEPROM_DEVICE_ADDRESS | ((u16address & 0x0700) >> 7) | WRITEMODE));
+	/* Send the device address of the block (A8 A9 A10) and R/W=0 (write) */
+	TWI_writeByte(EEPROM_SLA(block, WRITEMODE));
 	if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
-		return ERROR;
+		return EEPROM_abort();
 
 	/* Send the required memory location address */
 	TWI_writeByte((uint8)(u16address));
 	if (TWI_getStatus() != TWI_MT_DATA_ACK)
-		return ERROR;
+		return EEPROM_abort();
 
 	/* Send the Repeated Start Bit */
 	TWI_start();
 	if (TWI_getStatus() != TWI_REP_START)
-		return ERROR;
+		return EEPROM_abort();
 
-	/* Send the device address, we need to get A8 A9 A10 address bits from the
-	 * memory location address and R/W=1 (Read) */
-	TWI_writeByte((uint8)(EEPROM_DEVICE_ADDRESS | ((u16address & 0x0700) >> 7) | READMODE));
+	/* Send the device address of the block (A8 A9 A10) and R/W=1 (Read) */
+	TWI_writeByte(EEPROM_SLA(block, READMODE));
 	if (TWI_getStatus() != TWI_MT_SLA_R_ACK)
-		return ERROR;
+		return EEPROM_abort();
 
 	/* Read Byte from Memory without send ACK */
 	*u8data = TWI_readByteWithNACK();
 	if (TWI_getStatus() != TWI_MR_DATA_NACK)
-		return ERROR;
+		return EEPROM_abort();
 
 	/* Send the Stop Bit */
 	TWI_stop();
@@ -95,26 +149,29 @@ ErrorStatus_t EEPROM_readByte(uint16 u16address, uint8 *u8data)
 
 ErrorStatus_t EEPROM_writePage(uint16 u16address, uint8 *u8data, uint8 u8length)
 {
+	const TWI_DeviceType *block = EEPROM_BLOCK(u16address);
 	uint8 i;
+	/* bit rate of the EEPROM */
+	TWI_select(block);
+
 	/* Send the Start Bit */
 	TWI_start();
 	if (TWI_getStatus() != TWI_START)
-		return ERROR;
-	/* Send the device address, we need to get A8 A9 A10 address bits from the
-	 * memory location address and R/W=0 (write) */
-	TWI_writeByte((uint8)(EEPROM_DEVICE_ADDRESS | ((u16address & 0x0700) >> 7) | WRITEMODE));
+		return EEPROM_abort();
+	/* Send the device address of the block (A8 A9 A10) and R/W=0 (write) */
+	TWI_writeByte(EEPROM_SLA(block, WRITEMODE));
 	if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
-		return ERROR;
+		return EEPROM_abort();
 	/* Send the required memory location address */
 	TWI_writeByte((uint8)(u16address));
 	if (TWI_getStatus() != TWI_MT_DATA_ACK)
-		return ERROR;
+		return EEPROM_abort();
 	/* write byte to eeprom */
 	for (i = 0; i < u8length; i++)
 	{
 		TWI_writeByte(u8data[i]);
 		if (TWI_getStatus() != TWI_MT_DATA_ACK)
-			return ERROR;
+			return EEPROM_abort();
 	}
 	/* Send the Stop Bit */
 	TWI_stop();
@@ -123,37 +180,79 @@ ErrorStatus_t EEPROM_writePage(uint16 u16address, uint8 *u8data, uint8 u8length)
 
 ErrorStatus_t EEPROM_readPage(uint16 u16address, uint8 *u8data, uint8 u8length)
 {
+	const TWI_DeviceType *block = EEPROM_BLOCK(u16address);
 	uint8 i;
+	/* bit rate of the EEPROM */
+	TWI_select(block);
+
 	/* Send the Start Bit */
 	TWI_start();
 	if (TWI_getStatus() != TWI_START)
-		return ERROR;
-	/* Send the device address, we need to get A8 A9 A10 address bits from the
-	 * memory location address and R/W=0 (write) */
-	TWI_writeByte((uint8)(EEPROM_DEVICE_ADDRESS | ((u16address & 0x0700) >> 7) | WRITEMODE));
+		return EEPROM_abort();
+	/* Send the device address of the block (A8 A9 A10) and R/W=0 (write) */
+	TWI_writeByte(EEPROM_SLA(block, WRITEMODE));
 	if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
-		return ERROR;
+		return EEPROM_abort();
 	/* Send the required memory location address */
 	TWI_writeByte((uint8)(u16address));
 	if (TWI_getStatus() != TWI_MT_DATA_ACK)
-		return ERROR;
+		return EEPROM_abort();
 	/* Send the Repeated Start Bit */
 	TWI_start();
 	if (TWI_getStatus() != TWI_REP_START)
-		return ERROR;
-	/* Send the device address, we need to get A8 A9 A10 address bits from the
-	 * memory location address and R/W=1 (Read) */
-	TWI_writeByte((uint8)((0xA0) | ((u16address & 0x0700) >> 7) | READMODE));
+		return EEPROM_abort();
+	/* Send the device address of the block (A8 A9 A10) and R/W=1 (Read) */
+	TWI_writeByte(EEPROM_SLA(block, READMODE));
 	if (TWI_getStatus() != TWI_MT_SLA_R_ACK)
-		return ERROR;
-	/* Read Byte from Memory without send ACK */
+		return EEPROM_abort();
+	/* Read the bytes with ACK, the last one without ACK so the EEPROM releases SDA before the STOP */
 	for (i = 0; i < u8length; i++)
 	{
-		u8data[i] = TWI_readByteWithACK();
-		if (TWI_getStatus() != TWI_MR_DATA_ACK)
-			return ERROR;
+		if (i + 1 < u8length)
+		{
+			u8data[i] = TWI_readByteWithACK();
+			if (TWI_getStatus() != TWI_MR_DATA_ACK)
+				return EEPROM_abort();
+		}
+		else
+		{
+			u8data[i] = TWI_readByteWithNACK();
+			if (TWI_getStatus() != TWI_MR_DATA_NACK)
+				return EEPROM_abort();
+		}
 	}
 	/* Send the Stop Bit */
 	TWI_stop();
 	return SUCCESS;
 }
+
+ErrorStatus_t EEPROM_readPageAsync(uint16 u16address, uint8 *u8data, uint8 u8length, void (*callBack)(TWI_ResultType))
+{
+	TWI_TransactionType transaction;
+
+	if (EEPROM_asyncResult == TWI_RESULT_PENDING || u8length == 0)
+		return ERROR;
+
+	EEPROM_asyncWordAddress = (uint8)(u16address);
+
+	transaction.device = EEPROM_BLOCK(u16address);
+	transaction.txBuffer = &EEPROM_asyncWordAddress;
+	transaction.txLength = 1;
+	transaction.rxBuffer = u8data;
+	transaction.rxLength = u8length;
+	transaction.result = &EEPROM_asyncResult;
+	transaction.callBack = callBack;
+
+	if (TWI_SubmitTransaction(&transaction) == FALSE)
+	{
+		EEPROM_asyncResult = TWI_RESULT_OK; // nothing is running
+		return ERROR;
+	}
+	return SUCCESS;
+}
+
+TWI_ResultType EEPROM_getAsyncResult(void)
+{
+	(void)TWI_IsIdle(); // runs the watchdog of the transaction queue
+	return EEPROM_asyncResult;
+}
@@ -14,12 +14,15 @@
 #define _EEPROM_H_
 
 #include "STD_TYPES.h"
+#include "TWI_services.h"
 
-#define EEPROM_DEVICE_ADDRESS 	(0xA0)
 #define WRITEMODE 				(0x00)
 #define READMODE 				(0x01)
 
 #define EEPROM_SLAVE_ADDRESS 	(0x01)
+
+/* bus speed of the EEPROM, other devices of the bus keep their own (TWI_DeviceType) */
+#define EEPROM_SCL_FREQUENCY 	FastMode_400Kb
 /*******************************************************************************
  *                      User Defined Types                                     *
  *******************************************************************************/
@@ -35,9 +38,11 @@ typedef enum
 
 /*
  * Description : Function to initialize the external EEPROM by initializing the I2C module inside the MC 
-				 with the required configuration structure to communicate with the EEPROM 
+				 with the required configuration structure to communicate with the EEPROM,
+				 then its bus address and speed are taken from the device registry (I2C_REGISTRY)
  * Input       : void
  * Output      : void
+ * Note        : the first call scans the bus (about 15 ms at 100 kHz)
  */
 void EEPROM_init(void);
 
@@ -74,4 +79,24 @@ ErrorStatus_t EEPROM_writePage(uint16 u16address, uint8 *u8data, uint8 u8length)
  * Output      : ErrorStatus_t
  */
 ErrorStatus_t EEPROM_readPage(uint16 u16address, uint8 *u8data, uint8 u8length);
+
+/*
+ * Description : Function to start reading a block from the external EEPROM in the background,
+ * 				 the bytes are read by the TWI interrupt while the application keeps running
+ * Input       : - u16address -> the address of the location to read from
+ * 				 - u8data -> pointer to the buffer that will hold the read data (must stay valid until the end)
+ * 				 - u8length -> the length of the data to read (1 .. 255, the read continues in the next block)
+ * 				 - callBack -> called from the interrupt with the result, NULL_PTR for none
+ * Output      : ErrorStatus_t : ERROR if the previous background read is not complete
+ * 				 or the TWI transaction queue is full
+ */
+ErrorStatus_t EEPROM_readPageAsync(uint16 u16address, uint8 *u8data, uint8 u8length, void (*callBack)(TWI_ResultType));
+
+/*
+ * Description : Function to get the result of the last background read
+ * Input       : void
+ * Output      : TWI_ResultType : TWI_RESULT_PENDING while it is running, TWI_RESULT_OK when the data is ready,
+ * 				 TWI_RESULT_TIMEOUT if the bus was stuck (Timer2_Tick_init must be called)
+ */
+TWI_ResultType EEPROM_getAsyncResult(void);
 #endif // _EEPROM_H_
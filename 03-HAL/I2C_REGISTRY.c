@@ -0,0 +1,83 @@
+/******************************************************************************
+ *
+ * Module: I2C device registry
+ *
+ * File Name: I2C_REGISTRY.c
+ *
+ * Description: Source file for the registry of the devices found on the TWI bus
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+#include "I2C_REGISTRY.h"
+
+#include "TWI_services.h"
+
+/* one line of I2C_REGISTRY_TABLE */
+typedef struct
+{
+	uint8 firstAddress;
+	uint8 lastAddress;
+	uint32 sclFrequency;
+} I2C_REGISTRY_EntryType;
+
+static const I2C_REGISTRY_EntryType I2C_REGISTRY_Table[I2C_REGISTRY_DEVICES] = I2C_REGISTRY_TABLE;
+
+static TWI_DeviceType I2C_REGISTRY_Devices[I2C_REGISTRY_DEVICES];
+static boolean I2C_REGISTRY_found[I2C_REGISTRY_DEVICES];
+
+static uint8 I2C_REGISTRY_scan[I2C_REGISTRY_MAX_SCAN];
+static uint8 I2C_REGISTRY_scanCount = 0;
+static boolean I2C_REGISTRY_scanned = FALSE;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+void I2C_REGISTRY_init(void)
+{
+	const I2C_REGISTRY_EntryType *entry;
+	uint8 type;
+	uint8 i;
+
+	if (I2C_REGISTRY_scanned == TRUE)
+	{
+		return; // every driver may call it from its init
+	}
+	I2C_REGISTRY_scanned = TRUE;
+
+	I2C_REGISTRY_scanCount = TWI_ScanBus(I2C_REGISTRY_scan, I2C_REGISTRY_MAX_SCAN);
+
+	for (type = 0; type < I2C_REGISTRY_DEVICES; type++)
+	{
+		entry = &I2C_REGISTRY_Table[type];
+		I2C_REGISTRY_found[type] = FALSE;
+
+		for (i = 0; i < I2C_REGISTRY_scanCount; i++)
+		{
+			if (I2C_REGISTRY_scan[i] >= entry->firstAddress && I2C_REGISTRY_scan[i] <= entry->lastAddress)
+			{
+				/* the bit rate is computed once here, the same way as TWI_DEVICE */
+				I2C_REGISTRY_Devices[type].address = I2C_REGISTRY_scan[i];
+				I2C_REGISTRY_Devices[type].twbr = (uint8)TWI_TWBR_VALUE(entry->sclFrequency);
+				I2C_REGISTRY_Devices[type].twps = (uint8)TWI_TWPS_VALUE(entry->sclFrequency);
+				I2C_REGISTRY_found[type] = TRUE;
+				break;
+			}
+		}
+	}
+}
+
+const TWI_DeviceType *I2C_REGISTRY_getDevice(I2C_REGISTRY_DeviceType a_type)
+{
+	if (a_type >= I2C_REGISTRY_DEVICES || I2C_REGISTRY_found[a_type] == FALSE)
+	{
+		return NULL_PTR;
+	}
+	return &I2C_REGISTRY_Devices[a_type];
+}
+
+uint8 I2C_REGISTRY_getScan(const uint8 **ptr_addresses)
+{
+	*ptr_addresses = I2C_REGISTRY_scan;
+	return I2C_REGISTRY_scanCount;
+}
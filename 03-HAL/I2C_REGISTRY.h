@@ -0,0 +1,51 @@
+/******************************************************************************
+ *
+ * Module: I2C device registry
+ *
+ * File Name: I2C_REGISTRY.h
+ *
+ * Description: Header file for the registry of the devices found on the TWI bus
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+#ifndef I2C_REGISTRY_H_
+#define I2C_REGISTRY_H_
+
+#include "I2C_REGISTRY_config.h"
+#include "STD_TYPES.h"
+#include "TWI.h"
+
+/*************************************************************************************************************
+ * The bus is enumerated once (TWI_ScanBus), then every device type of I2C_REGISTRY_TABLE gets the first
+ * answering address of its range and its bit rate as a TWI_DeviceType, which the drivers keep from their
+ * init instead of building the slave address on every transaction.
+ *************************************************************************************************************/
+
+/*************************************************************************************************************
+ *   										Functions Prototypes										 	 *
+ * ***********************************************************************************************************/
+
+/*
+ * Description : Scan the bus and resolve the device types, only the first call scans.
+ * arguments   : None
+ * Return      : None
+ * Note        : TWI_init must be called first, the scan takes about 15 ms (see TWI_ScanBus)
+ */
+void I2C_REGISTRY_init(void);
+
+/*
+ * Description : Address and bit rate of a device type.
+ * arguments   : I2C_REGISTRY_DeviceType a_type : the device type
+ * Return      : const TWI_DeviceType * : the device, NULL_PTR if it didn't answer (or I2C_REGISTRY_init wasn't called)
+ */
+const TWI_DeviceType *I2C_REGISTRY_getDevice(I2C_REGISTRY_DeviceType a_type);
+
+/*
+ * Description : Addresses that answered the scan, for diagnostics.
+ * arguments   : const uint8 **ptr_addresses : set to the addresses in increasing order
+ * Return      : uint8 : number of addresses (at most I2C_REGISTRY_MAX_SCAN)
+ */
+uint8 I2C_REGISTRY_getScan(const uint8 **ptr_addresses);
+
+#endif /* I2C_REGISTRY_H_ */
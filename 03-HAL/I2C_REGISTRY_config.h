@@ -0,0 +1,38 @@
+/******************************************************************************
+ *
+ * Module: I2C device registry
+ *
+ * File Name: I2C_REGISTRY_config.h
+ *
+ * Description: Static configuration file for the I2C device registry
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+#ifndef I2C_REGISTRY_CONFIG_H_
+#define I2C_REGISTRY_CONFIG_H_
+
+#include "TWI.h"
+
+/******************* Device types *********************************/
+typedef enum
+{
+	I2C_REGISTRY_EEPROM,		  // 24C16: the 8 blocks of 256 bytes answer at 0x50 .. 0x57
+	I2C_REGISTRY_DISTANCE_SENSOR, // Ultrasonic_sensor_APP served over I2C (ULTRASONIC_I2C_SLAVE)
+	I2C_REGISTRY_DEVICES
+} I2C_REGISTRY_DeviceType;
+
+/*
+ * Addresses where every device type may answer (the first answering one is used) and its bus speed,
+ * one line per device type in the order of I2C_REGISTRY_DeviceType: {first, last, SCL frequency}
+ */
+#define I2C_REGISTRY_TABLE                                           \
+	{                                                                \
+		{0x50, 0x50, FastMode_400Kb},   /* block 0 of the EEPROM */   \
+		{0x30, 0x37, NormalMode_100Kb}                               \
+	}
+
+/* answering addresses kept from the scan (I2C_REGISTRY_getScan) */
+#define I2C_REGISTRY_MAX_SCAN 		16
+
+#endif /* I2C_REGISTRY_CONFIG_H_ */
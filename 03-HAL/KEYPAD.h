@@ -25,12 +25,20 @@
 #define KEYPAD_NUM_COLS 				 4
 #define KEYPAD_NUM_ROWS 				 4
 
-/* Keypad Port Configurations */
+/* Keypad Port Configurations, an application can override them from the compiler flags (see bin/Makefile) */
+#ifndef KEYPAD_ROW_PORT_ID
 #define KEYPAD_ROW_PORT_ID 				 PORTB_ID
+#endif
+#ifndef KEYPAD_FIRST_ROW_PIN_ID
 #define KEYPAD_FIRST_ROW_PIN_ID			 PIN0_ID
+#endif
 
+#ifndef KEYPAD_COL_PORT_ID
 #define KEYPAD_COL_PORT_ID 				 PORTB_ID
+#endif
+#ifndef KEYPAD_FIRST_COL_PIN_ID
 #define KEYPAD_FIRST_COL_PIN_ID 		 PIN4_ID
+#endif
 
 /* Keypad button logic configurations */
 #define KEYPAD_BUTTON_PRESSED 			 LOGIC_LOW
@@ -18,7 +18,8 @@
 #include "GPIO.h"
 #include "LCD.h"
 
-#include <stdlib.h> // for itoa() function and dtostrf()
+#include "FORMAT.h" // for the number conversions and LCD_printf
+
 /*******************************************************************************
  *                      private Functions                                      *
  *******************************************************************************/
@@ -296,67 +297,79 @@ void LCD_displaySpecialCharacter(uint8 *Pattern, uint8 Location)
  */
 void LCD_displayInteger(sint32 num)
 {
-	uint8 str[32]; /* create char array to store the digits of the number in it */
+	/* powers-of-ten subtraction instead of a 32-bit division and modulo per digit */
+	FORMAT_printf(LCD_displayCharacter, "%ld", num);
+}
 
-	uint8 i = 0;		  // index
-	uint8 isNegative = 0; // flag
+/*
+ * Description :
+ * Display the required float value on the screen
+ */
+void LCD_displayFloat(float32 num, uint8 numAfterDecimal)
+{
+	/*
+	 * print the integer and the fraction parts as two integers without dtostrf,
+	 * only the fraction is scaled so any value fits (the integer part is clamped to uint32)
+	 */
+	float32 scale = 1.0f;
+	uint32 integerPart;
+	uint32 fractionPart;
+	boolean negative = FALSE;
+	uint8 i;
 
-	if (num == 0)
+	if (numAfterDecimal > LCD_FLOAT_MAX_DECIMALS)
 	{
-		LCD_displayCharacter('0');
-		return;
+		numAfterDecimal = LCD_FLOAT_MAX_DECIMALS;
 	}
-	else
+	for (i = 0; i < numAfterDecimal; i++)
 	{
-		if (num < 0) // if the number is negative
-		{
-			isNegative = 1; // set the flag
-			num = num * -1; // make the number positive
-		}
-		do // we use do while to make sure that the loop will run at least once even if the number is 0
-		{
-			int mod = num % 10;	  // get the remainder
-			str[i++] = mod + '0'; // convert the remainder to char and put it in the array and increment the index
+		scale *= 10.0f;
+	}
 
-			num = num / 10; // update the number (remove the last digit)
-		} while (num > 0);	// num is positive
+	if (num < 0)
+	{
+		negative = TRUE;
+		num = -num;
+	}
+	num += 0.5f / scale; // round the last digit
 
-		if (isNegative) // if the number is negative
+	if (num >= 4294967295.0f)
+	{
+		integerPart = 0xFFFFFFFFUL;
+		fractionPart = 0;
+	}
+	else
+	{
+		integerPart = (uint32)num;
+		fractionPart = (uint32)((num - (float32)integerPart) * scale);
+		if (fractionPart >= (uint32)scale)
 		{
-			str[i++] = '-'; // put the negative sign at the end of the string and increment the index
+			fractionPart = (uint32)scale - 1; // float rounding of the last digit
 		}
-		str[i] = 0; //! null at the end
 	}
 
-	/*
-	 * the array of this number is reversed
-	 * so we need to reverse it easier to print each char in the array from the last element to the first one
-	 * we already have the index of the last char in the array (i)
-	 * //! but note that i is the index of the null char at this momment so we need to decrement it by 1
-	 */
-
-	i--; // decrement i by 1
-
-	for (int k = i; k >= 0; k--) // don't forget = in <= (if the number is 2 digits)
+	if (negative == TRUE && (integerPart != 0 || fractionPart != 0))
 	{
-		LCD_displayCharacter(str[k]);
+		LCD_displayCharacter('-');
+	}
+	FORMAT_printf(LCD_displayCharacter, "%lu", integerPart);
+	if (numAfterDecimal != 0)
+	{
+		FORMAT_printf(LCD_displayCharacter, ".%0*lu", numAfterDecimal, fractionPart);
 	}
-
-	// =================== another way ===================
-	// char buff[16];			 /* String to hold the ascii result */
-	// itoa(data, buff, 10);	 /* Use itoa C function to convert the data to its corresponding ASCII value, 10 for decimal */
-	// LCD_displayString(buff); /* Display the string */
 }
 
 /*
  * Description :
- * Display the required decimal value on the screen
+ * Display a formatted string on the screen (see FORMAT.h for the supported conversions)
  */
-void LCD_displayFloat(float32 num, uint8 numAfterDecimal)
+void LCD_printf(const char *format, ...)
 {
-	char buff[16]; /* String to hold the ascii result */
-	dtostrf(num, 2, numAfterDecimal, buff);
-	LCD_displayString(buff); /* Display the string */
+	va_list args;
+
+	va_start(args, format);
+	FORMAT_vprintf(LCD_displayCharacter, format, args);
+	va_end(args);
 }
 
 /*
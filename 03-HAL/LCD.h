@@ -34,6 +34,8 @@
 #define LCD_CURSOR_ON 0x0E						/* when cursor is on, no need to blink */
 #define LCD_SET_CURSOR_LOCATION 0x80			/* Set cursor position in DDRAM */
 
+#define LCD_FLOAT_MAX_DECIMALS 4 /* LCD_displayFloat: digits after the decimal point (float32 precision) */
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -100,6 +102,13 @@ void LCD_displayInteger(sint32 num);
  */
 void LCD_displayFloat(float32 num, uint8 numAfterDecimal);
 
+/*
+ * Description :
+ * Display a formatted string on the screen, e.g. LCD_printf("T=%3d C %.1q V", temp, mv / 100)
+ * (see FORMAT.h for the supported conversions, no float)
+ */
+void LCD_printf(const char *format, ...);
+
 /*
  * Description :
  * Display Binary number on the screen (8-bits)
@@ -0,0 +1,308 @@
+/******************************************************************************
+ *
+ * Module: SPI NOR flash
+ *
+ * File Name: SPI_FLASH.c
+ *
+ * Description: Source file for the W25Qxx class SPI NOR flash driver
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+#include "SPI_FLASH.h"
+
+#include "SPI.h"
+#include "SPI_FLASH_config.h"
+
+#ifdef SPI_FLASH_HOST_MODEL
+#include "SPI_FLASH_model.h"
+#else
+#include <util/delay.h>
+#endif
+
+/* largest supported chip, limited by the 24-bit addresses */
+#define SPI_FLASH_MAX_CAPACITY 		24
+
+/*******************************************************************************
+ *                      Private Variables                                      *
+ *******************************************************************************/
+#ifndef SPI_FLASH_HOST_MODEL
+static SPI_DeviceType SPI_FLASH_Device = {SPI_FLASH_CS_PORT_ID, SPI_FLASH_CS_PIN_ID, SPI_MODE_0,
+										  SPI_FLASH_CLOCK_RATE, SPI_FLASH_DOUBLE_SPEED, SPI_MSB_FIRST, 0, 0};
+#endif
+
+static uint8 SPI_FLASH_jedecId[3] = {0, 0, 0};
+static uint32 SPI_FLASH_size = 0;
+
+static uint8 SPI_FLASH_cache[SPI_FLASH_CACHE_SIZE];
+static uint32 SPI_FLASH_cacheAddress = 0; // flash address of SPI_FLASH_cache[0]
+static boolean SPI_FLASH_cacheValid = FALSE;
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+#ifdef SPI_FLASH_HOST_MODEL
+#define SPI_FLASH_SELECT() 		SPI_FLASH_MODEL_select()
+#define SPI_FLASH_DESELECT() 	SPI_FLASH_MODEL_deselect()
+#define SPI_FLASH_POLL_DELAY()
+#define SPI_FLASH_WAKE_UP_DELAY()
+
+/* same behaviour as SPI_transferBlock */
+static void SPI_FLASH_Transfer(const uint8 *a_tx, uint8 *a_rx, uint16 a_length)
+{
+	uint16 i;
+	uint8 data;
+
+	for (i = 0; i < a_length; i++)
+	{
+		data = SPI_FLASH_MODEL_transferByte((a_tx != NULL_PTR) ? a_tx[i] : SPI_DEFAULT_DATA_VALUE);
+		if (a_rx != NULL_PTR)
+		{
+			a_rx[i] = data;
+		}
+	}
+}
+#else
+#define SPI_FLASH_SELECT() 		SPI_select(&SPI_FLASH_Device)
+#define SPI_FLASH_DESELECT() 	SPI_deselect(&SPI_FLASH_Device)
+#define SPI_FLASH_POLL_DELAY() 	_delay_us(SPI_FLASH_POLL_PERIOD_US)
+#define SPI_FLASH_WAKE_UP_DELAY() _delay_us(3) // tRES1
+#define SPI_FLASH_Transfer 		SPI_transferBlock
+#endif
+
+/* one byte command without address or data */
+static void SPI_FLASH_Command(uint8 a_command)
+{
+	SPI_FLASH_SELECT();
+	SPI_FLASH_Transfer(&a_command, NULL_PTR, 1);
+	SPI_FLASH_DESELECT();
+}
+
+/* command with a 24-bit address, the chip stays selected for the data phase */
+static void SPI_FLASH_CommandAddress(uint8 a_command, uint32 a_address, uint8 a_dummyBytes)
+{
+	uint8 header[5];
+
+	header[0] = a_command;
+	header[1] = (uint8)(a_address >> 16);
+	header[2] = (uint8)(a_address >> 8);
+	header[3] = (uint8)a_address;
+	header[4] = 0x00; // dummy byte of the fast read
+
+	SPI_FLASH_SELECT();
+	SPI_FLASH_Transfer(header, NULL_PTR, 4 + a_dummyBytes);
+}
+
+static uint8 SPI_FLASH_ReadStatus(void)
+{
+	uint8 frame[2] = {SPI_FLASH_CMD_READ_STATUS1, SPI_DEFAULT_DATA_VALUE};
+
+	SPI_FLASH_SELECT();
+	SPI_FLASH_Transfer(frame, frame, 2);
+	SPI_FLASH_DESELECT();
+
+	return frame[1];
+}
+
+static SPI_FLASH_StatusType SPI_FLASH_WaitReady(uint16 a_timeoutMs)
+{
+	uint32 polls = (uint32)a_timeoutMs * (1000UL / SPI_FLASH_POLL_PERIOD_US);
+
+	while (SPI_FLASH_ReadStatus() & SPI_FLASH_SR_BUSY)
+	{
+		if (polls == 0)
+		{
+			return SPI_FLASH_TIMEOUT;
+		}
+		polls--;
+		SPI_FLASH_POLL_DELAY();
+	}
+	return SPI_FLASH_OK;
+}
+
+static SPI_FLASH_StatusType SPI_FLASH_WriteEnable(void)
+{
+	SPI_FLASH_Command(SPI_FLASH_CMD_WRITE_ENABLE);
+
+	/* WEL stays cleared while the chip is write protected (WP pin, status register protection) */
+	if (!(SPI_FLASH_ReadStatus() & SPI_FLASH_SR_WEL))
+	{
+		return SPI_FLASH_WRITE_PROTECTED;
+	}
+	return SPI_FLASH_OK;
+}
+
+static boolean SPI_FLASH_IsInRange(uint32 a_address, uint32 a_length)
+{
+	return (a_address < SPI_FLASH_size && a_length <= SPI_FLASH_size - a_address) ? TRUE : FALSE;
+}
+
+/* the cached line is dropped if [a_address, a_address + a_length) overlaps it */
+static void SPI_FLASH_InvalidateCache(uint32 a_address, uint32 a_length)
+{
+	if (SPI_FLASH_cacheValid == TRUE && a_address < SPI_FLASH_cacheAddress + SPI_FLASH_CACHE_SIZE &&
+		SPI_FLASH_cacheAddress < a_address + a_length)
+	{
+		SPI_FLASH_cacheValid = FALSE;
+	}
+}
+
+static void SPI_FLASH_FastRead(uint32 a_address, uint8 *a_buffer, uint16 a_length)
+{
+	SPI_FLASH_CommandAddress(SPI_FLASH_CMD_FAST_READ, a_address, 1);
+	SPI_FLASH_Transfer(NULL_PTR, a_buffer, a_length);
+	SPI_FLASH_DESELECT();
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+SPI_FLASH_StatusType SPI_FLASH_init(void)
+{
+	uint8 command = SPI_FLASH_CMD_JEDEC_ID;
+
+#ifndef SPI_FLASH_HOST_MODEL
+	SPI_init(SPI_Master, SPI_FLASH_CLOCK_RATE);
+	SPI_Device_init(&SPI_FLASH_Device);
+#endif
+
+	SPI_FLASH_size = 0;
+	SPI_FLASH_cacheValid = FALSE;
+
+	/* the chip ignores every other command in power down */
+	SPI_FLASH_Command(SPI_FLASH_CMD_RELEASE_PD);
+	SPI_FLASH_WAKE_UP_DELAY();
+
+	SPI_FLASH_SELECT();
+	SPI_FLASH_Transfer(&command, NULL_PTR, 1);
+	SPI_FLASH_Transfer(NULL_PTR, SPI_FLASH_jedecId, 3);
+	SPI_FLASH_DESELECT();
+
+	/* MISO floating high or held low -> no chip */
+	if (SPI_FLASH_jedecId[0] == 0x00 || SPI_FLASH_jedecId[0] == 0xFF || SPI_FLASH_jedecId[2] == 0x00)
+	{
+		return SPI_FLASH_NOT_FOUND;
+	}
+
+	SPI_FLASH_size = 1UL << ((SPI_FLASH_jedecId[2] < SPI_FLASH_MAX_CAPACITY) ? SPI_FLASH_jedecId[2] : SPI_FLASH_MAX_CAPACITY);
+	return SPI_FLASH_OK;
+}
+
+void SPI_FLASH_GetJedecId(uint8 *a_id)
+{
+	uint8 i;
+
+	for (i = 0; i < 3; i++)
+	{
+		a_id[i] = SPI_FLASH_jedecId[i];
+	}
+}
+
+uint32 SPI_FLASH_GetSize(void)
+{
+	return SPI_FLASH_size;
+}
+
+SPI_FLASH_StatusType SPI_FLASH_read(uint32 a_address, uint8 *a_buffer, uint16 a_length)
+{
+	uint32 lineAddress;
+	uint16 offset; // reaches SPI_FLASH_CACHE_SIZE (256 allowed)
+
+	if (SPI_FLASH_IsInRange(a_address, a_length) == FALSE)
+	{
+		return SPI_FLASH_OUT_OF_RANGE;
+	}
+
+	/* long reads stream at the bus speed, the cache would only add a copy */
+	if (a_length >= SPI_FLASH_CACHE_SIZE)
+	{
+		SPI_FLASH_FastRead(a_address, a_buffer, a_length);
+		return SPI_FLASH_OK;
+	}
+
+	/* short reads touch one or two lines */
+	while (a_length != 0)
+	{
+		lineAddress = a_address & ~((uint32)SPI_FLASH_CACHE_SIZE - 1);
+		if (SPI_FLASH_cacheValid == FALSE || SPI_FLASH_cacheAddress != lineAddress)
+		{
+			SPI_FLASH_FastRead(lineAddress, SPI_FLASH_cache, SPI_FLASH_CACHE_SIZE);
+			SPI_FLASH_cacheAddress = lineAddress;
+			SPI_FLASH_cacheValid = TRUE;
+		}
+
+		for (offset = (uint16)(a_address - lineAddress); offset < SPI_FLASH_CACHE_SIZE && a_length != 0; offset++)
+		{
+			*a_buffer++ = SPI_FLASH_cache[offset];
+			a_address++;
+			a_length--;
+		}
+	}
+	return SPI_FLASH_OK;
+}
+
+SPI_FLASH_StatusType SPI_FLASH_write(uint32 a_address, const uint8 *a_data, uint16 a_length)
+{
+	SPI_FLASH_StatusType status;
+	uint16 chunk;
+
+	if (SPI_FLASH_IsInRange(a_address, a_length) == FALSE)
+	{
+		return SPI_FLASH_OUT_OF_RANGE;
+	}
+	SPI_FLASH_InvalidateCache(a_address, a_length);
+
+	while (a_length != 0)
+	{
+		/* a page program wraps at the end of the page, so every page is programmed separately */
+		chunk = SPI_FLASH_PAGE_SIZE - (uint16)(a_address & (SPI_FLASH_PAGE_SIZE - 1));
+		if (chunk > a_length)
+		{
+			chunk = a_length;
+		}
+
+		status = SPI_FLASH_WriteEnable();
+		if (status != SPI_FLASH_OK)
+		{
+			return status;
+		}
+
+		SPI_FLASH_CommandAddress(SPI_FLASH_CMD_PAGE_PROGRAM, a_address, 0);
+		SPI_FLASH_Transfer(a_data, NULL_PTR, chunk);
+		SPI_FLASH_DESELECT(); // starts the program
+
+		status = SPI_FLASH_WaitReady(SPI_FLASH_PROGRAM_TIMEOUT_MS);
+		if (status != SPI_FLASH_OK)
+		{
+			return status;
+		}
+
+		a_address += chunk;
+		a_data += chunk;
+		a_length -= chunk;
+	}
+	return SPI_FLASH_OK;
+}
+
+SPI_FLASH_StatusType SPI_FLASH_eraseSector(uint32 a_address)
+{
+	SPI_FLASH_StatusType status;
+
+	if (SPI_FLASH_IsInRange(a_address, 1) == FALSE)
+	{
+		return SPI_FLASH_OUT_OF_RANGE;
+	}
+	a_address &= ~(SPI_FLASH_SECTOR_SIZE - 1);
+	SPI_FLASH_InvalidateCache(a_address, SPI_FLASH_SECTOR_SIZE);
+
+	status = SPI_FLASH_WriteEnable();
+	if (status != SPI_FLASH_OK)
+	{
+		return status;
+	}
+
+	SPI_FLASH_CommandAddress(SPI_FLASH_CMD_SECTOR_ERASE, a_address, 0);
+	SPI_FLASH_DESELECT(); // starts the erase
+
+	return SPI_FLASH_WaitReady(SPI_FLASH_ERASE_TIMEOUT_MS);
+}
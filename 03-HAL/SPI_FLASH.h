@@ -0,0 +1,109 @@
+/******************************************************************************
+ *
+ * Module: SPI NOR flash
+ *
+ * File Name: SPI_FLASH.h
+ *
+ * Description: Header file for the W25Qxx class SPI NOR flash driver
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+#ifndef SPI_FLASH_H_
+#define SPI_FLASH_H_
+
+#include "STD_TYPES.h"
+
+/*************************************************************************************************************
+ * The chip is a device of the SPI bus (SPI_DeviceType, mode 0), so it can share the bus with other chips.
+ * Reads use the fast read command and SPI_transferBlock, about 1 MB/s at SCK = 8 MHz.
+ * Programming only clears bits: a sector must be erased (all 0xFF) before it is written again.
+ * Addresses are 24-bit, so chips bigger than 16 MB are used up to 16 MB.
+ *
+ * Building with -DSPI_FLASH_HOST_MODEL replaces the bus by SPI_FLASH_MODEL (same command set in RAM)
+ * to run the driver on a PC.
+ *************************************************************************************************************/
+
+#define SPI_FLASH_PAGE_SIZE 		256U
+#define SPI_FLASH_SECTOR_SIZE 		4096UL
+
+/* Commands */
+#define SPI_FLASH_CMD_WRITE_ENABLE 	0x06
+#define SPI_FLASH_CMD_READ_STATUS1 	0x05
+#define SPI_FLASH_CMD_READ_DATA 	0x03
+#define SPI_FLASH_CMD_FAST_READ 	0x0B
+#define SPI_FLASH_CMD_PAGE_PROGRAM 	0x02
+#define SPI_FLASH_CMD_SECTOR_ERASE 	0x20
+#define SPI_FLASH_CMD_JEDEC_ID 		0x9F
+#define SPI_FLASH_CMD_RELEASE_PD 	0xAB
+
+/* Status register 1 */
+#define SPI_FLASH_SR_BUSY 			0x01
+#define SPI_FLASH_SR_WEL 			0x02
+
+/*******************************************************************************
+ *                      User Defined Types                                     *
+ *******************************************************************************/
+typedef enum
+{
+	SPI_FLASH_OK,
+	SPI_FLASH_NOT_FOUND,		// no answer to the JEDEC ID command
+	SPI_FLASH_OUT_OF_RANGE,		// the access goes past the end of the chip
+	SPI_FLASH_WRITE_PROTECTED,	// the write enable latch could not be set
+	SPI_FLASH_TIMEOUT			// the chip stayed busy longer than the datasheet maximum
+} SPI_FLASH_StatusType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : Initialize the SPI as master and the chip select, wake the chip up and read its JEDEC ID
+ * 				 to get its size.
+ * arguments   : None
+ * Return      : SPI_FLASH_StatusType : SPI_FLASH_OK, SPI_FLASH_NOT_FOUND
+ */
+SPI_FLASH_StatusType SPI_FLASH_init(void);
+
+/*
+ * Description : Get the JEDEC ID read by SPI_FLASH_init.
+ * arguments   : uint8 *a_id : 3 bytes: manufacturer (0xEF for Winbond), memory type, capacity (log2 of the size)
+ * Return      : None
+ */
+void SPI_FLASH_GetJedecId(uint8 *a_id);
+
+/*
+ * Description : Size of the chip in bytes, 0 if it wasn't found.
+ */
+uint32 SPI_FLASH_GetSize(void);
+
+/*
+ * Description : Read a_length bytes starting at a_address.
+ * arguments   : uint32 a_address : flash address
+ * 				 uint8 *a_buffer : buffer for the data
+ * 				 uint16 a_length : number of bytes
+ * Return      : SPI_FLASH_StatusType : SPI_FLASH_OK, SPI_FLASH_OUT_OF_RANGE
+ * Note        : reads shorter than SPI_FLASH_CACHE_SIZE go through the RAM cache
+ */
+SPI_FLASH_StatusType SPI_FLASH_read(uint32 a_address, uint8 *a_buffer, uint16 a_length);
+
+/*
+ * Description : Program a_length bytes starting at a_address, split on the page boundaries,
+ * 				 waiting for the end of every page program.
+ * arguments   : uint32 a_address : flash address
+ * 				 const uint8 *a_data : data to write
+ * 				 uint16 a_length : number of bytes
+ * Return      : SPI_FLASH_StatusType : SPI_FLASH_OK, SPI_FLASH_OUT_OF_RANGE, SPI_FLASH_WRITE_PROTECTED, SPI_FLASH_TIMEOUT
+ * Note        : the bytes must be erased first, programming only clears bits
+ */
+SPI_FLASH_StatusType SPI_FLASH_write(uint32 a_address, const uint8 *a_data, uint16 a_length);
+
+/*
+ * Description : Erase (set to 0xFF) the 4 KB sector holding a_address and wait for the end of the erase.
+ * arguments   : uint32 a_address : any address in the sector
+ * Return      : SPI_FLASH_StatusType : SPI_FLASH_OK, SPI_FLASH_OUT_OF_RANGE, SPI_FLASH_WRITE_PROTECTED, SPI_FLASH_TIMEOUT
+ * Note        : this function is blocking function (up to 400 ms)
+ */
+SPI_FLASH_StatusType SPI_FLASH_eraseSector(uint32 a_address);
+
+#endif /* SPI_FLASH_H_ */
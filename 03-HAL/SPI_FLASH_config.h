@@ -0,0 +1,44 @@
+/******************************************************************************
+ *
+ * Module: SPI NOR flash
+ *
+ * File Name: SPI_FLASH_config.h
+ *
+ * Description: Static configuration file for the W25Qxx SPI NOR flash driver
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+#ifndef SPI_FLASH_CONFIG_H_
+#define SPI_FLASH_CONFIG_H_
+
+#include "GPIO.h"
+
+/******************* Chip select *********************************/
+#define SPI_FLASH_CS_PORT_ID 			PORTB_ID
+#define SPI_FLASH_CS_PIN_ID 			PIN4_ID
+
+/******************* Bus speed *********************************/
+/* SPI_FOSC_4 with double speed -> SCK = F_CPU / 2 (8 MHz at 16 MHz, the chip supports up to 104 MHz) */
+#define SPI_FLASH_CLOCK_RATE 			SPI_FOSC_4
+#define SPI_FLASH_DOUBLE_SPEED 			TRUE
+
+/******************* Read cache *********************************/
+/*
+ * One aligned line of the flash kept in RAM, reads shorter than the line are served from it
+ * (table lookups, log headers), longer reads go straight to the bus.
+ * Must be a power of two, at most the page size.
+ */
+#define SPI_FLASH_CACHE_SIZE 			32
+
+/******************* Busy polling *********************************/
+#define SPI_FLASH_POLL_PERIOD_US 		50
+/* worst case of the W25Q datasheets */
+#define SPI_FLASH_PROGRAM_TIMEOUT_MS 	3
+#define SPI_FLASH_ERASE_TIMEOUT_MS 		400
+
+#if ((SPI_FLASH_CACHE_SIZE & (SPI_FLASH_CACHE_SIZE - 1)) != 0) || (SPI_FLASH_CACHE_SIZE > 256)
+#error "SPI_FLASH_CACHE_SIZE must be a power of two up to 256"
+#endif
+
+#endif /* SPI_FLASH_CONFIG_H_ */
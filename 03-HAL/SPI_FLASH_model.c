@@ -0,0 +1,207 @@
+/******************************************************************************
+ *
+ * Module: SPI NOR flash
+ *
+ * File Name: SPI_FLASH_model.c
+ *
+ * Description: Source file for the host (PC) model of a W25Qxx flash
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+#ifdef SPI_FLASH_HOST_MODEL
+
+#include "SPI_FLASH_model.h"
+
+#include "SPI_FLASH.h"
+
+/*******************************************************************************
+ *                      Private Variables                                      *
+ *******************************************************************************/
+static uint8 SPI_FLASH_MODEL_memory[SPI_FLASH_MODEL_SIZE];
+
+static boolean SPI_FLASH_MODEL_selected = FALSE;
+static boolean SPI_FLASH_MODEL_writeEnabled = FALSE;
+static boolean SPI_FLASH_MODEL_poweredDown = FALSE;
+static uint8 SPI_FLASH_MODEL_busyPolls = 0;
+
+/* state of the current command */
+static uint8 SPI_FLASH_MODEL_command = 0;
+static uint32 SPI_FLASH_MODEL_byteIndex = 0; // bytes received since the select, the command included
+static uint32 SPI_FLASH_MODEL_address = 0;
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+static boolean SPI_FLASH_MODEL_HasAddress(uint8 a_command)
+{
+	return (a_command == SPI_FLASH_CMD_READ_DATA || a_command == SPI_FLASH_CMD_FAST_READ ||
+			a_command == SPI_FLASH_CMD_PAGE_PROGRAM || a_command == SPI_FLASH_CMD_SECTOR_ERASE)
+			   ? TRUE
+			   : FALSE;
+}
+
+/* data phase of the command, a_data is the byte on MOSI */
+static uint8 SPI_FLASH_MODEL_Data(uint8 a_data)
+{
+	uint8 response = 0xFF;
+	uint32 page;
+
+	switch (SPI_FLASH_MODEL_command)
+	{
+	case SPI_FLASH_CMD_JEDEC_ID:
+		if (SPI_FLASH_MODEL_byteIndex == 1)
+			response = SPI_FLASH_MODEL_MANUFACTURER_ID;
+		else if (SPI_FLASH_MODEL_byteIndex == 2)
+			response = SPI_FLASH_MODEL_MEMORY_TYPE;
+		else if (SPI_FLASH_MODEL_byteIndex == 3)
+			response = SPI_FLASH_MODEL_CAPACITY;
+		break;
+
+	case SPI_FLASH_CMD_READ_STATUS1:
+		response = (SPI_FLASH_MODEL_busyPolls != 0 ? SPI_FLASH_SR_BUSY : 0) |
+				   (SPI_FLASH_MODEL_writeEnabled == TRUE ? SPI_FLASH_SR_WEL : 0);
+		if (SPI_FLASH_MODEL_busyPolls != 0)
+		{
+			SPI_FLASH_MODEL_busyPolls--;
+		}
+		break;
+
+	case SPI_FLASH_CMD_FAST_READ:
+		if (SPI_FLASH_MODEL_byteIndex == 4)
+		{
+			break; // dummy byte
+		}
+		/* fall through */
+	case SPI_FLASH_CMD_READ_DATA:
+		response = SPI_FLASH_MODEL_memory[SPI_FLASH_MODEL_address];
+		SPI_FLASH_MODEL_address = (SPI_FLASH_MODEL_address + 1) & (SPI_FLASH_MODEL_SIZE - 1);
+		break;
+
+	case SPI_FLASH_CMD_PAGE_PROGRAM:
+		if (SPI_FLASH_MODEL_writeEnabled == TRUE)
+		{
+			/* programming clears bits only, the address wraps in the page */
+			SPI_FLASH_MODEL_memory[SPI_FLASH_MODEL_address] &= a_data;
+			page = SPI_FLASH_MODEL_address & ~((uint32)SPI_FLASH_PAGE_SIZE - 1);
+			SPI_FLASH_MODEL_address = page | ((SPI_FLASH_MODEL_address + 1) & (SPI_FLASH_PAGE_SIZE - 1));
+		}
+		break;
+
+	default:
+		break;
+	}
+	return response;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+void SPI_FLASH_MODEL_reset(void)
+{
+	uint32 i;
+
+	for (i = 0; i < SPI_FLASH_MODEL_SIZE; i++)
+	{
+		SPI_FLASH_MODEL_memory[i] = 0xFF;
+	}
+	SPI_FLASH_MODEL_selected = FALSE;
+	SPI_FLASH_MODEL_writeEnabled = FALSE;
+	SPI_FLASH_MODEL_poweredDown = FALSE;
+	SPI_FLASH_MODEL_busyPolls = 0;
+}
+
+void SPI_FLASH_MODEL_select(void)
+{
+	SPI_FLASH_MODEL_selected = TRUE;
+	SPI_FLASH_MODEL_byteIndex = 0;
+	SPI_FLASH_MODEL_address = 0;
+}
+
+void SPI_FLASH_MODEL_deselect(void)
+{
+	uint32 i;
+
+	if (SPI_FLASH_MODEL_selected == FALSE || SPI_FLASH_MODEL_byteIndex == 0)
+	{
+		SPI_FLASH_MODEL_selected = FALSE;
+		return;
+	}
+	SPI_FLASH_MODEL_selected = FALSE;
+
+	switch (SPI_FLASH_MODEL_command)
+	{
+	case SPI_FLASH_CMD_WRITE_ENABLE:
+		SPI_FLASH_MODEL_writeEnabled = TRUE;
+		break;
+
+	case SPI_FLASH_CMD_RELEASE_PD:
+		SPI_FLASH_MODEL_poweredDown = FALSE;
+		break;
+
+	case SPI_FLASH_CMD_PAGE_PROGRAM:
+		if (SPI_FLASH_MODEL_writeEnabled == TRUE && SPI_FLASH_MODEL_byteIndex > 4)
+		{
+			SPI_FLASH_MODEL_writeEnabled = FALSE;
+			SPI_FLASH_MODEL_busyPolls = SPI_FLASH_MODEL_BUSY_POLLS;
+		}
+		break;
+
+	case SPI_FLASH_CMD_SECTOR_ERASE:
+		/* executed only if CS goes high right after the last address bit */
+		if (SPI_FLASH_MODEL_writeEnabled == TRUE && SPI_FLASH_MODEL_byteIndex == 4)
+		{
+			SPI_FLASH_MODEL_address &= ~(SPI_FLASH_SECTOR_SIZE - 1);
+			for (i = 0; i < SPI_FLASH_SECTOR_SIZE; i++)
+			{
+				SPI_FLASH_MODEL_memory[SPI_FLASH_MODEL_address + i] = 0xFF;
+			}
+			SPI_FLASH_MODEL_writeEnabled = FALSE;
+			SPI_FLASH_MODEL_busyPolls = SPI_FLASH_MODEL_BUSY_POLLS;
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+uint8 SPI_FLASH_MODEL_transferByte(uint8 a_data)
+{
+	uint8 response = 0xFF; // MISO floats high when the chip doesn't drive it
+
+	if (SPI_FLASH_MODEL_selected == FALSE)
+	{
+		return response;
+	}
+
+	if (SPI_FLASH_MODEL_byteIndex == 0)
+	{
+		SPI_FLASH_MODEL_command = a_data;
+
+		/* only the status and the wake up are accepted while busy or in power down */
+		if ((SPI_FLASH_MODEL_busyPolls != 0 && a_data != SPI_FLASH_CMD_READ_STATUS1) ||
+			(SPI_FLASH_MODEL_poweredDown == TRUE && a_data != SPI_FLASH_CMD_RELEASE_PD))
+		{
+			SPI_FLASH_MODEL_command = 0;
+		}
+	}
+	else if (SPI_FLASH_MODEL_HasAddress(SPI_FLASH_MODEL_command) == TRUE && SPI_FLASH_MODEL_byteIndex <= 3)
+	{
+		SPI_FLASH_MODEL_address = ((SPI_FLASH_MODEL_address << 8) | a_data) & (SPI_FLASH_MODEL_SIZE - 1);
+	}
+	else
+	{
+		response = SPI_FLASH_MODEL_Data(a_data);
+	}
+
+	SPI_FLASH_MODEL_byteIndex++;
+	return response;
+}
+
+uint8 *SPI_FLASH_MODEL_getMemory(void)
+{
+	return SPI_FLASH_MODEL_memory;
+}
+
+#endif /* SPI_FLASH_HOST_MODEL */
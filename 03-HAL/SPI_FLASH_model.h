@@ -0,0 +1,56 @@
+/******************************************************************************
+ *
+ * Module: SPI NOR flash
+ *
+ * File Name: SPI_FLASH_model.h
+ *
+ * Description: Header file for the host (PC) model of a W25Qxx flash, used by SPI_FLASH.c
+ * 				when it is built with -DSPI_FLASH_HOST_MODEL
+ *
+ * Author: Hossam Mohamed
+ *
+ *******************************************************************************/
+#ifndef SPI_FLASH_MODEL_H_
+#define SPI_FLASH_MODEL_H_
+
+#include "STD_TYPES.h"
+
+/*************************************************************************************************************
+ * The model answers the bytes of the bus like the chip: JEDEC ID, release power down, read status 1,
+ * write enable, read, fast read, page program (clears bits only, wraps in the page) and sector erase.
+ * Program and erase need the write enable latch and keep the chip busy for SPI_FLASH_MODEL_BUSY_POLLS
+ * status reads, other commands are ignored while busy.
+ *************************************************************************************************************/
+
+/* W25Q80: Winbond, 1 MB */
+#define SPI_FLASH_MODEL_MANUFACTURER_ID 	0xEF
+#define SPI_FLASH_MODEL_MEMORY_TYPE 		0x40
+#define SPI_FLASH_MODEL_CAPACITY 			0x14
+#define SPI_FLASH_MODEL_SIZE 				(1UL << SPI_FLASH_MODEL_CAPACITY)
+
+#define SPI_FLASH_MODEL_BUSY_POLLS 			3
+
+/*
+ * Description : Erase the whole memory (0xFF) and reset the chip state.
+ */
+void SPI_FLASH_MODEL_reset(void);
+
+/*
+ * Description : Chip select low/high, a command starts at every select and program/erase run at the deselect.
+ */
+void SPI_FLASH_MODEL_select(void);
+void SPI_FLASH_MODEL_deselect(void);
+
+/*
+ * Description : Exchange one byte with the chip.
+ * arguments   : uint8 a_data : byte on MOSI
+ * Return      : uint8 : byte on MISO
+ */
+uint8 SPI_FLASH_MODEL_transferByte(uint8 a_data);
+
+/*
+ * Description : Direct access to the memory of the model, to check the result of the driver.
+ */
+uint8 *SPI_FLASH_MODEL_getMemory(void);
+
+#endif /* SPI_FLASH_MODEL_H_ */
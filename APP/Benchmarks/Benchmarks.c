@@ -0,0 +1,272 @@
+/***********************************************************************************************
+ * creator: Hossam Mohamed
+ * Description: Cycle count benchmarks of the drivers (see Benchmarks.h)
+ * 				- FORMAT : FORMAT_printf against avr-libc sprintf/dtostrf/ltoa
+ * 						   and the division based loop of the old LCD_displayInteger
+ * 				- SPI    : SPI_transferBlock against a SPI_sendReceiveByte loop at every Clock_Rate_t
+ * 						   (master, MOSI can be left open or looped back to MISO)
+ * 				- TWI    : 16-byte EEPROM page read/write routines (blocking) against the TWI
+ * 						   transaction queue at 100 kHz and 400 kHz (24C16 on PC0/PC1, last block)
+ ************************************************************************************************/
+#include "Benchmarks.h"
+
+#include "EEPROM.h"
+#include "FORMAT.h"
+#include "SOFT_I2C.h"
+#include "SPI.h"
+#include "TIMER.h"
+#include "TWI_services.h"
+#include "UART.h"
+#include "UART_Services.h"
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <stdio.h>	// sprintf (vfprintf) as a reference
+#include <stdlib.h> // dtostrf and ltoa as a reference
+#include <util/delay.h>
+
+#include "SETTINGS.h" // for F_CPU
+
+// =========================== Configurations ================================ //
+UART_ConfigType Benchmark_UART_Config = {UART_8_BIT_DATA, UART_NO_PARITY, UART_1_STOP_BIT, BAUD_9600};
+Timer1_ConfigType Benchmark_Timer1_Config = {0, 0, TIMER1_NORMAL_MODE, F_CPU_CLOCK, OCRA_DISCONNECTED, OCRB_DISCONNECTED};
+
+// =========================== Measurement ================================== //
+static uint16 Benchmark_Overhead = 0; // cycles of an empty measurement
+
+/* Cycles taken by the statement (up to 65535), interrupts are disabled during the measurement */
+#define BENCHMARK_MEASURE(result, statement)                        \
+	do                                                              \
+	{                                                               \
+		uint8 sreg = SREG;                                          \
+		uint16 start;                                               \
+		cli();                                                      \
+		start = Timer1_ReadTCNT1();                                 \
+		statement;                                                  \
+		(result) = Timer1_ReadTCNT1() - start - Benchmark_Overhead; \
+		SREG = sreg;                                                \
+	} while (0)
+
+/* Same as BENCHMARK_MEASURE for a statement that needs the interrupts, other interrupts add to the result */
+#define BENCHMARK_MEASURE_IRQ(result, statement)                    \
+	do                                                              \
+	{                                                               \
+		uint16 start = Timer1_ReadTCNT1();                          \
+		statement;                                                  \
+		(result) = Timer1_ReadTCNT1() - start - Benchmark_Overhead; \
+	} while (0)
+
+static void Benchmark_Report(const char *name, uint16 driverCycles, uint16 referenceCycles)
+{
+	UART_printf("%-16s %6u %6u\r\n", name, driverCycles, referenceCycles);
+}
+
+// =========================== FORMAT ======================================= //
+static volatile uint8 Benchmark_SinkLast; // keeps the null sink from being optimized away
+
+static void Benchmark_NullSink(uint8 a_char)
+{
+	Benchmark_SinkLast = a_char;
+}
+
+/* the division/modulo conversion of the old LCD_displayInteger, for comparison */
+static void Benchmark_DivModInteger(sint32 num, char *str)
+{
+	uint8 i = 0;
+	uint8 k;
+	char reversed[12];
+
+	if (num < 0)
+	{
+		*str++ = '-';
+		num = -num;
+	}
+	do
+	{
+		reversed[i++] = (num % 10) + '0';
+		num = num / 10;
+	} while (num > 0);
+	for (k = 0; k < i; k++)
+	{
+		str[k] = reversed[i - 1 - k];
+	}
+	str[i] = '\0';
+}
+
+static void Benchmark_Format(void)
+{
+	char buffer[24];
+	volatile sint32 value32 = -1234567L; // volatile: no constant folding of the conversions
+	volatile uint16 value16 = 54321U;
+	volatile float32 valueFloat = 12.34f;
+	uint16 driverCycles, referenceCycles;
+
+	UART_printf("FORMAT            cycles  ref\r\n");
+
+	BENCHMARK_MEASURE(driverCycles, FORMAT_printf(Benchmark_NullSink, "%ld", value32));
+	BENCHMARK_MEASURE(referenceCycles, sprintf(buffer, "%ld", value32));
+	Benchmark_Report("%ld / sprintf", driverCycles, referenceCycles);
+
+	BENCHMARK_MEASURE(referenceCycles, ltoa(value32, buffer, 10));
+	Benchmark_Report("%ld / ltoa", driverCycles, referenceCycles);
+
+	BENCHMARK_MEASURE(referenceCycles, Benchmark_DivModInteger(value32, buffer));
+	Benchmark_Report("%ld / div-mod", driverCycles, referenceCycles);
+
+	BENCHMARK_MEASURE(driverCycles, FORMAT_printf(Benchmark_NullSink, "%u", value16));
+	BENCHMARK_MEASURE(referenceCycles, sprintf(buffer, "%u", value16));
+	Benchmark_Report("%u / sprintf", driverCycles, referenceCycles);
+
+	BENCHMARK_MEASURE(driverCycles, FORMAT_printf(Benchmark_NullSink, "%04x", value16));
+	BENCHMARK_MEASURE(referenceCycles, sprintf(buffer, "%04x", value16));
+	Benchmark_Report("%04x / sprintf", driverCycles, referenceCycles);
+
+	/* fixed point against the float path it replaces in LCD_displayFloat */
+	BENCHMARK_MEASURE(driverCycles, FORMAT_printf(Benchmark_NullSink, "%.2q", 1234));
+	BENCHMARK_MEASURE(referenceCycles, dtostrf(valueFloat, 2, 2, buffer));
+	Benchmark_Report("%.2q / dtostrf", driverCycles, referenceCycles);
+}
+
+// =========================== SPI ========================================== //
+#define BENCHMARK_SPI_BLOCK 32 // 32 bytes at F_CPU / 128 still fit the 16-bit cycle counter
+
+static void Benchmark_SPI(void)
+{
+	static const char *const rateNames[] = {"FOSC/4", "FOSC/16", "FOSC/64", "FOSC/128"};
+	uint8 tx[BENCHMARK_SPI_BLOCK];
+	uint8 rx[BENCHMARK_SPI_BLOCK];
+	uint16 driverCycles, referenceCycles;
+	uint8 i;
+	Clock_Rate_t rate;
+
+	for (i = 0; i < BENCHMARK_SPI_BLOCK; i++)
+	{
+		tx[i] = i;
+	}
+
+	UART_printf("SPI %u B          cycles  ref    B/s    ref B/s\r\n", BENCHMARK_SPI_BLOCK);
+
+	for (rate = SPI_FOSC_4; rate <= SPI_FOSC_128; rate++)
+	{
+		SPI_init(SPI_Master, rate);
+
+		BENCHMARK_MEASURE(driverCycles, SPI_transferBlock(tx, rx, BENCHMARK_SPI_BLOCK));
+		BENCHMARK_MEASURE(referenceCycles, for (i = 0; i < BENCHMARK_SPI_BLOCK; i++) rx[i] = SPI_sendReceiveByte(tx[i]));
+
+		UART_printf("%-16s %6u %6u %6lu %6lu\r\n", rateNames[rate], driverCycles, referenceCycles,
+					(uint32)BENCHMARK_SPI_BLOCK * F_CPU / driverCycles, (uint32)BENCHMARK_SPI_BLOCK * F_CPU / referenceCycles);
+	}
+}
+
+// =========================== TWI ========================================== //
+#define BENCHMARK_TWI_BLOCK 	16		/* one page of the 24C16 */
+#define BENCHMARK_EEPROM_ADDRESS 0x0700 /* last block, not used by the door locker */
+
+/* the block of BENCHMARK_EEPROM_ADDRESS at the two standard speeds (F_CPU limits them, see TWI.h) */
+static const TWI_DeviceType Benchmark_TWI_Devices[] = {TWI_DEVICE(0x57, NormalMode_100Kb), TWI_DEVICE(0x57, FastMode_400Kb)};
+
+static void Benchmark_TWI(void)
+{
+	static const char *const deviceNames[] = {"queue rd 100k", "queue rd 400k"};
+	static const uint8 wordAddress = (uint8)BENCHMARK_EEPROM_ADDRESS;
+	uint8 buffer[BENCHMARK_TWI_BLOCK];
+	uint16 cycles;
+	uint8 i;
+	volatile TWI_ResultType result;
+	TWI_TransactionType transaction = {NULL_PTR, &wordAddress, 1, buffer, BENCHMARK_TWI_BLOCK, &result, NULL_PTR};
+
+	for (i = 0; i < BENCHMARK_TWI_BLOCK; i++)
+	{
+		buffer[i] = i;
+	}
+
+	EEPROM_init();
+
+	UART_printf("TWI %u B          cycles    B/s\r\n", BENCHMARK_TWI_BLOCK);
+
+	/* bus time only, the EEPROM write cycle (up to 10 ms) follows the STOP */
+	BENCHMARK_MEASURE(cycles, EEPROM_writePage(BENCHMARK_EEPROM_ADDRESS, buffer, BENCHMARK_TWI_BLOCK));
+	UART_printf("%-16s %6u %6lu\r\n", "EEPROM wr page", cycles, (uint32)BENCHMARK_TWI_BLOCK * F_CPU / cycles);
+	_delay_ms(10);
+
+	BENCHMARK_MEASURE(cycles, EEPROM_readPage(BENCHMARK_EEPROM_ADDRESS, buffer, BENCHMARK_TWI_BLOCK));
+	UART_printf("%-16s %6u %6lu\r\n", "EEPROM rd page", cycles, (uint32)BENCHMARK_TWI_BLOCK * F_CPU / cycles);
+
+	for (i = 0; i < sizeof(Benchmark_TWI_Devices) / sizeof(Benchmark_TWI_Devices[0]); i++)
+	{
+		transaction.device = &Benchmark_TWI_Devices[i];
+		/* TWI_IsIdle ends a stuck transaction with TWI_RESULT_TIMEOUT */
+		BENCHMARK_MEASURE_IRQ(cycles, TWI_SubmitTransaction(&transaction); while (TWI_IsIdle() == FALSE));
+
+		if (result == TWI_RESULT_OK)
+		{
+			UART_printf("%-16s %6u %6lu\r\n", deviceNames[i], cycles, (uint32)BENCHMARK_TWI_BLOCK * F_CPU / cycles);
+		}
+		else
+		{
+			UART_printf("%-16s error %u\r\n", deviceNames[i], result);
+		}
+	}
+}
+
+// =========================== Software I2C ================================= //
+/*
+ * SCL rate of the bit-banged master at this F_CPU: a block is clocked out to an address without a
+ * device (every byte is 9 SCL periods, acknowledged or not), so only the pull ups of the pins of
+ * SOFT_I2C_config.h are needed.
+ */
+#define BENCHMARK_SOFT_I2C_ADDRESS 0x7F /* reserved address (not the general call 0x00), no device answers */
+static void Benchmark_SOFT_I2C(void)
+{
+	uint8 buffer[BENCHMARK_TWI_BLOCK];
+	uint16 cycles;
+	uint8 i;
+
+	for (i = 0; i < BENCHMARK_TWI_BLOCK; i++)
+	{
+		buffer[i] = i;
+	}
+	buffer[0] = (uint8)(BENCHMARK_SOFT_I2C_ADDRESS << 1); // the first byte after the START is SLA+W
+
+	SOFT_I2C_init();
+
+	UART_printf("SOFT_I2C %u B     cycles    B/s  SCL Hz\r\n", BENCHMARK_TWI_BLOCK);
+
+	SOFT_I2C_start();
+	BENCHMARK_MEASURE(cycles, for (i = 0; i < BENCHMARK_TWI_BLOCK; i++) SOFT_I2C_writeByte(buffer[i]));
+	SOFT_I2C_stop();
+
+	if (SOFT_I2C_getStatus() == TWI_TIMEOUT || SOFT_I2C_getStatus() == TWI_ARB_LOST)
+	{
+		UART_printf("%-16s error %u (pull ups?)\r\n", "write", SOFT_I2C_getStatus());
+	}
+	else
+	{
+		UART_printf("%-16s %6u %6lu %7lu\r\n", "write", cycles, (uint32)BENCHMARK_TWI_BLOCK * F_CPU / cycles,
+					(uint32)BENCHMARK_TWI_BLOCK * 9UL * F_CPU / cycles);
+	}
+}
+
+// =========================== Main ========================================= //
+void Benchmarks_main(void)
+{
+	uint16 empty;
+
+	UART_init(&Benchmark_UART_Config);
+	Timer1_init(&Benchmark_Timer1_Config);
+	Timer2_Tick_init(); // watchdog of the TWI transaction queue
+	sei(); // for MODE == INTERRUPT
+
+	BENCHMARK_MEASURE(empty, (void)0);
+	Benchmark_Overhead = empty;
+
+	UART_printf("\r\nBenchmarks @ %lu Hz\r\n", F_CPU);
+	Benchmark_Format();
+	Benchmark_SPI();
+	Benchmark_TWI();
+	Benchmark_SOFT_I2C();
+
+	while (1)
+	{
+	}
+}
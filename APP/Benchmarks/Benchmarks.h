@@ -0,0 +1,12 @@
+/***********************************************************************************************
+ * creator: Hossam Mohamed
+ * Description: Cycle count benchmarks of the drivers, the results are printed through UART
+ * 				(8N1, 9600 baud) as a table: name, cycles of the driver, cycles of the reference.
+ * 				Timer1 runs at F_CPU and is read around every measurement with interrupts disabled.
+ ************************************************************************************************/
+#ifndef BENCHMARKS_H /* HEADER GUARD */
+#define BENCHMARKS_H
+
+void Benchmarks_main(void); // main function of the benchmarks
+
+#endif /* BENCHMARKS_H */
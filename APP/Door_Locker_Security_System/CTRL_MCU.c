@@ -19,7 +19,7 @@
 #include "EEPROM.h"
 
 #include "TIMER.h"
-#include "UART_Services.h"
+#include "LINK.h"
 
 #include <avr/interrupt.h> // for sei() function
 #include <util/delay.h>	   // for _delay_ms() function
@@ -33,14 +33,16 @@
 volatile DoorState_t DoorState = IDLE;
 volatile uint8 TimerFlag = FALSE;
 
-volatile uint8 UARTflag = FALSE;
-volatile uint8 UART_INT_ReceivedData = 0;
-
 uint32 SavedPassword; // variable to save password from EEPROM
 
-//================================ Global Configurations Types ===================================
-UART_ConfigType UART_CONTROL_Config = {UART_8_BIT_DATA, UART_1_STOP_BIT, UART_NO_PARITY, BAUD_9600};
+//====================================== Link Services Functions ================================
+static void ReceivePassword(uint32 *a_password)
+{
+	uint8 length;
+	LINK_ReceiveFrame((uint8 *)a_password, &length, sizeof(uint32));
+}
 
+//================================ Global Configurations Types ===================================
 // when F_CPU = 8MHz and prescaler = 1024 => 1 tick = 128 us => 3 sec = 23436 ticks
 // for less interrupts as the maximum time we want to calculate is 3 seconds
 Timer1_ConfigType Timer1_Door_config = {0, 23436U, TIMER1_CTC_OCR1A_MODE, F_CPU_1024, OCRA_DISCONNECTED, OCRB_DISCONNECTED};
@@ -73,22 +75,44 @@ void Timer1_Motor_ISR()
 	}
 }
 
-void UART_RECEIVE_ISR()
+//====================================== Lock System Functions ==================================
+/* wait a_time_ms while listening to the HMI (its messages are acknowledged frames), TRUE when it ends the lock */
+static boolean SystemLocked_Wait(uint16 a_time_ms)
 {
-	UART_INT_ReceivedData = UART_ReceiveByteNoBlock();
+	uint8 HMI_response = 0;
+
+	return (LINK_ReceiveByteTimeout(&HMI_response, a_time_ms) == LINK_OK && HMI_response == UART_OPERATION_SUCCESS)
+			   ? TRUE
+			   : FALSE;
 }
 
-//====================================== Lock System Functions ==================================
 void SystemLocked_CTRL()
 {
-	UART_RX_InterruptEnable();
-	while (UART_INT_ReceivedData != UART_OPERATION_SUCCESS)
+	boolean unlocked = FALSE;
+	uint8 i;
+
+	// the alarm sounds until the HMI ends the locked screen, same pattern as Buzzer_Alarm
+	while (unlocked == FALSE)
 	{
-		Buzzer_Alarm();
+		for (i = 0; i < 6 && unlocked == FALSE; i++)
+		{
+			if (i % 2 == 0)
+			{
+				Buzzer_on();
+			}
+			else
+			{
+				Buzzer_off();
+			}
+			unlocked = SystemLocked_Wait(100);
+		}
+		Buzzer_off();
+
+		if (unlocked == FALSE)
+		{
+			unlocked = SystemLocked_Wait(1000); // pause between alarm patterns
+		}
 	}
-	UART_INT_ReceivedData = 0;
-	Buzzer_off();
-	UART_RX_InterruptDisable();
 }
 
 //=================================== EEPROM services Functions =================================
@@ -130,18 +154,23 @@ void EEPROM_resetPassword()
 //=================================== System Options Functions =================================
 void DoorOperation_CTRL()
 {
-	DoorState = OPEN_DOOR; // set initial state to open door
-
-	Timer1_init(&Timer1_Door_config);
-	Timer1_OCA_InterruptEnable();
+	uint8 HMI_response = 0;
 
 	//=================== Wait for HMI Ready ==============
-	while (UART_ReceiveByte() != UART_HMI_READY)
+	while (HMI_response != UART_HMI_READY)
 	{
-		/* code */
+		if (LINK_ReceiveByteTimeout(&HMI_response, UART_RESPONSE_TIMEOUT) == LINK_TIMEOUT)
+		{
+			return; // HMI is not responding, keep the door closed and go back to the options
+		}
 	}
 	//=======================================================
 
+	DoorState = OPEN_DOOR; // set initial state to open door
+
+	Timer1_init(&Timer1_Door_config);
+	Timer1_OCA_InterruptEnable();
+
 	while (TimerFlag == FALSE)
 	{
 		if (DoorState != IDLE)
@@ -149,17 +178,17 @@ void DoorOperation_CTRL()
 			switch (DoorState)
 			{
 			case OPEN_DOOR:
-				UART_SendByte(UART_OPEN_DOOR);
+				LINK_SendByte(UART_OPEN_DOOR);
 				DCMOTOR_Rotate(DCMOTOR_CLOCKWISE, 100);
 				DoorState = IDLE; // reset state
 				break;
 			case DOOR_WAITING:
-				UART_SendByte(UART_DOOR_WAITING);
+				LINK_SendByte(UART_DOOR_WAITING);
 				DCMOTOR_Rotate(DCMOTOR_STOP, 0);
 				DoorState = IDLE; // reset state
 				break;
 			case CLOSE_DOOR:
-				UART_SendByte(UART_CLOSE_DOOR);
+				LINK_SendByte(UART_CLOSE_DOOR);
 				DCMOTOR_Rotate(DCMOTOR_ANTI_CLOCKWISE, 100);
 				DoorState = IDLE; // reset state
 				break;
@@ -168,7 +197,7 @@ void DoorOperation_CTRL()
 	}
 	TimerFlag = FALSE; // reset flag
 
-	UART_SendByte(UART_OPERATION_SUCCESS);
+	LINK_SendByte(UART_OPERATION_SUCCESS);
 	DCMOTOR_Rotate(DCMOTOR_STOP, 0);
 	Timer1_OCA_InterruptDisable();
 }
@@ -183,27 +212,26 @@ void ChangePasswordOperation_CTRL()
 	while (isPasswordCorrect == 0)
 	{
 		//=================== Wait for HMI Ready ==============
-		while (UART_ReceiveByte() != UART_CHANGE_PASSWORD) // first signal from HMI
+		while (LINK_ReceiveByte() != UART_CHANGE_PASSWORD) // first signal from HMI
 		{
 		}
-		UART_SendByte(UART_CHANGE_PASSWORD); // send signal to HMI to start sending password
+		LINK_SendByte(UART_CHANGE_PASSWORD); // send signal to HMI to start sending password
 		//=======================================================
-		//_delay_ms(50);
-		UART_ReceiveFourBytes(&OldPassword);
+		ReceivePassword(&OldPassword);
 		EEPROM_ReadPassword(&SavedPassword);
 
 		if (OldPassword == SavedPassword)
 		{
-			UART_SendByte(UART_OPERATION_SUCCESS);
+			LINK_SendByte(UART_OPERATION_SUCCESS);
 			isPasswordCorrect = 1; // set flag to exit the loop
 
 			// when HMI return from CheckPassword
 
-			HMI_Response = UART_ReceiveByte();
+			HMI_Response = LINK_ReceiveByte();
 
 			if (HMI_Response == UART_OPERATION_SUCCESS) // second signal from HMI (user entered password twice correctly)
 			{
-				UART_ReceiveFourBytes(&NewPassword);
+				ReceivePassword(&NewPassword);
 				EEPROM_resetPassword(); // reset password in EEPROM
 				EEPROM_WritePassword(NewPassword);
 			}
@@ -214,14 +242,14 @@ void ChangePasswordOperation_CTRL()
 		}
 		else
 		{
-			UART_SendByte(UART_OPERATION_FAIL); // when both passwords are not equal
+			LINK_SendByte(UART_OPERATION_FAIL); // when both passwords are not equal
 			isPasswordCorrect = 0;				// set flag to continue the loop
 
 			// reset password variables (not reseting variables can cause overwriting the new password with the old one)
 			OldPassword = 0;
 			SavedPassword = 0;
 
-			if (UART_ReceiveByte() == UART_MAX_WRONG_PASSWORD)
+			if (LINK_ReceiveByte() == UART_MAX_WRONG_PASSWORD)
 			{
 				SystemLocked_CTRL();
 				return; // (MAXIMUM_WRONG_PASSWORDS) exit this function and return to main
@@ -233,13 +261,12 @@ void ChangePasswordOperation_CTRL()
 //==================================== System Functions =========================================
 void System_init_CTRL()
 {
-	UART_init(&UART_CONTROL_Config);
+	LINK_init(LINK_ROLE_CTRL);
 	EEPROM_init();
 
 	DCMOTOR_init();
 	Buzzer_init();
 
-	UART_RX_SetCallBack(UART_RECEIVE_ISR);
 	Timer1_OCA_SetCallBack(Timer1_Motor_ISR);
 
 	sei();
@@ -249,7 +276,7 @@ void SystemOptions_CTRL()
 {
 	uint8 option;
 
-	option = UART_ReceiveByte();
+	option = LINK_ReceiveByte();
 
 	switch (option)
 	{
@@ -272,11 +299,13 @@ void CTRL_MCU()
 	uint8 isFirstTime = 0;
 
 	//=================== Wait for HMI Ready ==============
-	UART_SendByte(UART_CONTROL_READY);
-	while (UART_ReceiveByte() != UART_HMI_READY)
+	// keep calling the HMI until it answers, whichever MCU powered up first
+	do
 	{
-		/* Do nothing */
-	}
+		LINK_SendByte(UART_CONTROL_READY);
+	} while (LINK_ReceiveByteTimeout(&HMI_response, UART_HANDSHAKE_TIMEOUT) == LINK_TIMEOUT ||
+			 HMI_response != UART_HMI_READY);
+	HMI_response = 0;
 	//=======================================================
 
 	// get isFirstTime from EEPROM to check if it's the first time to run the system
@@ -285,12 +314,12 @@ void CTRL_MCU()
 	// if isFirstTime == 1 then it's not the first time to run the system
 	if (isFirstTime == 1)
 	{
-		UART_SendByte(UART_Not_First_time);
+		LINK_SendByte(UART_Not_First_time);
 
 		// /* ============================= Testing ================================ */
 		// EEPROM_ReadPassword(&SavedPassword);
 		//_delay_ms(10);
-		// while (UART_ReceiveByte() != UART_HMI_READY)
+		// while (LINK_ReceiveByte() != UART_HMI_READY)
 		//{
 		//	/* Wait for HMI Ready to send password */
 		//}
@@ -298,18 +327,18 @@ void CTRL_MCU()
 	}
 	else
 	{
-		UART_SendByte(UART_First_time);
+		LINK_SendByte(UART_First_time);
 
 		_delay_ms(10);
 
 		while (HMI_response != UART_OPERATION_SUCCESS)
 		{
 			// Wait for HMI response to act opon it
-			HMI_response = UART_ReceiveByte();
+			HMI_response = LINK_ReceiveByte();
 
 			if (HMI_response == UART_OPERATION_SUCCESS) // if user create password successfully
 			{
-				UART_ReceiveFourBytes(&SavedPassword); // receive password from HMI and save it in SavedPassword variable
+				ReceivePassword(&SavedPassword); // receive password from HMI and save it in SavedPassword variable
 
 				EEPROM_WritePassword(SavedPassword); // write SavedPassword in EEPROM
 
@@ -15,11 +15,16 @@
 #include "System_config.h"
 
 #include "TIMER.h"
-#include "UART_Services.h"
+#include "LINK.h"
 
+#include "GPIO.h" // for the port ids of the keypad check
 #include "KEYPAD.h"
 #include "LCD.h"
 
+#if (LINK_TRANSPORT == LINK_TRANSPORT_SPI) && ((KEYPAD_ROW_PORT_ID == PORTB_ID) || (KEYPAD_COL_PORT_ID == PORTB_ID))
+#error "The SPI link uses PB2, PB4..PB7 of the HMI, move the keypad to another port (make LINK=SPI does it)"
+#endif
+
 #include <avr/interrupt.h> // for sei() function
 #include <util/delay.h>	   // for _delay_ms() function
 
@@ -32,13 +37,9 @@ volatile static uint8 Timer1_3sec_counter = 0;
 
 volatile static uint8 TimerFlag = FALSE;
 
-volatile static uint8 UART_INT_ReceivedData = 0;
-
 uint32 FirstPassword = 0;
 
 //================================ Global Configurations Types ===================================
-UART_ConfigType UART_HMI_Config = {UART_8_BIT_DATA, UART_1_STOP_BIT, UART_NO_PARITY, BAUD_9600};
-
 // when F_CPU = 8MHz and prescaler = 1024 => 1 tick = 128 us => 1 sec = 7812 ticks
 // we don't care here much about the number of interrupts as the system is locked (more accurate progress bar)
 Timer1_ConfigType Timer1_syslock_config = {0, 7812U, TIMER1_CTC_OCR1A_MODE, F_CPU_1024, OCRA_DISCONNECTED, OCRB_DISCONNECTED};
@@ -157,6 +158,27 @@ void ProgressBar(uint8 MaximumValue, uint8 CurrentValue)
 	}
 }
 
+//====================================== Link Services Functions ================================
+/* send a password frame, report a link error on the LCD if the CONTROL MCU never acknowledges it */
+static boolean SendPassword(const uint32 *a_password)
+{
+	uint8 attempt;
+
+	for (attempt = 0; attempt < LINK_FRAME_SEND_ATTEMPTS; attempt++)
+	{
+		if (LINK_SendFrame((const uint8 *)a_password, sizeof(uint32)) == LINK_OK)
+		{
+			return TRUE;
+		}
+	}
+
+	LCD_clearScreen();
+	LCD_displayStringCenter(0, "LINK ERROR");
+	LCD_displayStringCenter(1, "TRY AGAIN");
+	_delay_ms(LCD_WAITING_TIME);
+	return FALSE;
+}
+
 //======================================== ISRs =================================================
 static void TIMER1_ISR()
 {
@@ -181,11 +203,6 @@ static void TIMER1_ISR()
 	Timer1_3sec_counter += 3;
 }
 
-static void UART_RECEIVE_ISR()
-{
-	UART_INT_ReceivedData = UART_ReceiveByteNoBlock();
-}
-
 //====================================== Lock System Functions ==================================
 void SystemLocked_HMI()
 {
@@ -314,13 +331,10 @@ boolean CreatePassword()
 		PasswordsAreEqual = EnterPassword();
 		if (PasswordsAreEqual == TRUE)
 		{
-			_delay_ms(100);
+			LINK_SendByte(UART_OPERATION_SUCCESS); // send success signal to CONTROL MCU to be ready to receive the password
 
-			UART_SendByte(UART_OPERATION_SUCCESS); // send success signal to CONTROL MCU to be ready to receive the password
-
-			UART_SendFourBytes(FirstPassword);
-
-			return TRUE;
+			// the user creates the password again if the CONTROL MCU doesn't acknowledge it
+			return SendPassword(&FirstPassword);
 		}
 		else
 		{
@@ -329,12 +343,12 @@ boolean CreatePassword()
 			if (WrongPasswordCounter == MAXIMUM_WRONG_PASSWORDS)
 			{
 
-				UART_SendByte(UART_MAX_WRONG_PASSWORD);
+				LINK_SendByte(UART_MAX_WRONG_PASSWORD);
 
 				SystemLocked_HMI();
 
 				// signal to CONTROL to stop the buzzer
-				UART_SendByte(UART_OPERATION_SUCCESS);
+				LINK_SendByte(UART_OPERATION_SUCCESS);
 
 				WrongPasswordCounter = 0;
 				return FALSE;
@@ -346,35 +360,36 @@ boolean CreatePassword()
 boolean CheckOldPassword_int()
 {
 	uint32 OldPassword;
+	uint8 response;
 
 	uint8 WrongPasswordCounter = 0;
 
-	UART_RX_InterruptEnable();
-
 	while (1)
 	{
-		UART_INT_ReceivedData = 0;
 		LCD_clearScreen();
 		LCD_displayStringCenter(0, "ENTER OLD PASS");
 		OldPassword = GetPassword();
 
 		// first UART_CHANGE_PASSWORD signal
-		UART_SendByte(UART_CHANGE_PASSWORD); // send signal to CONTROL to start receiving the password
+		LINK_SendByte(UART_CHANGE_PASSWORD); // send signal to CONTROL to start receiving the password
 		//=================== Wait for CTRL Ready ==============
-		while (UART_INT_ReceivedData != UART_CHANGE_PASSWORD)
+		while (LINK_ReceiveByte() != UART_CHANGE_PASSWORD)
 		{
 		}
-		//_delay_ms(50); //!!!
 
-		UART_SendFourBytes(OldPassword);
-		_delay_ms(50); // delay to make sure that the CONTROL MCU received the password //!!!
+		if (SendPassword(&OldPassword) == FALSE)
+		{
+			return FALSE; // back to the main menu
+		}
+
+		// wait for the CONTROL MCU to check the password
+		response = LINK_ReceiveByte();
 
-		if (UART_INT_ReceivedData == UART_OPERATION_SUCCESS)
+		if (response == UART_OPERATION_SUCCESS)
 		{
-			UART_RX_InterruptDisable();
 			return TRUE;
 		}
-		else if (UART_INT_ReceivedData == UART_OPERATION_FAIL)
+		else if (response == UART_OPERATION_FAIL)
 		{
 			LCD_clearScreen();
 			LCD_displayStringCenter(0, "WRONG PASS");
@@ -386,12 +401,12 @@ boolean CheckOldPassword_int()
 
 			if (WrongPasswordCounter == MAXIMUM_WRONG_PASSWORDS)
 			{
-				UART_SendByte(UART_MAX_WRONG_PASSWORD);
+				LINK_SendByte(UART_MAX_WRONG_PASSWORD);
 
-				SystemLocked_HMI(); // interrupt will be disabled inside this function
+				SystemLocked_HMI();
 
 				// signal to CONTROL to stop the buzzer
-				UART_SendByte(UART_OPERATION_SUCCESS);
+				LINK_SendByte(UART_OPERATION_SUCCESS);
 
 				WrongPasswordCounter = 0;
 				return FALSE;
@@ -399,7 +414,7 @@ boolean CheckOldPassword_int()
 			else
 			{
 				// signal indicating that we didn't exceed the maximum wrong passwords yet
-				UART_SendByte(UART_OPERATION_SUCCESS);
+				LINK_SendByte(UART_OPERATION_SUCCESS);
 			}
 		}
 	}
@@ -408,37 +423,40 @@ boolean CheckOldPassword_int()
 //=================================== System Options Functions ==================================
 void DoorOperation_HMI()
 {
+	uint8 ReceivedData = 0;
+
 	Timer1_init(&Timer1_Door_config);
 
 	//=================== Send Ready to Control MCU =========
-	UART_SendByte(UART_HMI_READY);
+	LINK_SendByte(UART_HMI_READY);
 	//=======================================================
 	Timer1_OCA_InterruptEnable();
-	UART_RX_InterruptEnable();
 
-	while (UART_INT_ReceivedData != UART_OPERATION_SUCCESS)
+	while (ReceivedData != UART_OPERATION_SUCCESS)
 	{
+		// the CONTROL MCU sends the door state changes, the progress bar is updated meanwhile
+		if (LINK_ReadByte(&ReceivedData) == FALSE)
+		{
+			ReceivedData = 0;
+		}
 
-		if (UART_INT_ReceivedData == UART_OPEN_DOOR)
+		if (ReceivedData == UART_OPEN_DOOR)
 		{
 			LCD_clearScreen();
 			LCD_displayStringCenter(0, "OPENING DOOR =>");
 			DoorState = OPEN_DOOR;
-			UART_INT_ReceivedData = 0; // Clear the received data
 		}
-		else if (UART_INT_ReceivedData == UART_DOOR_WAITING)
+		else if (ReceivedData == UART_DOOR_WAITING)
 		{
 			LCD_clearScreen();
 			LCD_displayStringCenter(0, "   WAITING...  ");
 			DoorState = DOOR_WAITING;
-			UART_INT_ReceivedData = 0; // Clear the received data
 		}
-		else if (UART_INT_ReceivedData == UART_CLOSE_DOOR)
+		else if (ReceivedData == UART_CLOSE_DOOR)
 		{
 			LCD_clearScreen();
 			LCD_displayStringCenter(0, "<= CLOSING DOOR");
 			DoorState = CLOSE_DOOR;
-			UART_INT_ReceivedData = 0; // Clear the received data
 		}
 
 		LCD_Goto_XY(1, 0);
@@ -451,10 +469,8 @@ void DoorOperation_HMI()
 			ProgressBar(OPEN_CLOSE_DOOR_TIME, Timer1_3sec_counter - (OPEN_CLOSE_DOOR_TIME + WAITING_DOOR_TIME)); // Display the progress bar
 		}
 	}
-	UART_INT_ReceivedData = 0; // Clear the received data
 	DoorState = IDLE;
 
-	UART_RX_InterruptDisable();
 	Timer1_OCA_InterruptDisable();
 	LCD_clearScreen();
 }
@@ -476,6 +492,7 @@ void ChangePasswordOperation_HMI()
 	else
 	{
 		// at this point, user returned with (FALSE) from CheckOldPassword_int() function for exceeding the maximum wrong passwords
+		// (or for a link error)
 		// He will exit this function and return to system options function to display the main menu again
 		return;
 	}
@@ -491,7 +508,7 @@ void ChangePasswordOperation_HMI()
 
 		if (dummyUserCounter == MAXIMUM_WRONG_REPEATED_PASSWORDS)
 		{
-			UART_SendByte(UART_OPERATION_FAIL);
+			LINK_SendByte(UART_OPERATION_FAIL);
 
 			LCD_clearScreen();
 			LCD_displayStringCenter(0, "I DON'T THINK U");
@@ -503,10 +520,12 @@ void ChangePasswordOperation_HMI()
 	}
 
 	// second UART_OPERATION_SUCCESS signal
-	UART_SendByte(UART_OPERATION_SUCCESS);
-	_delay_ms(50);
+	LINK_SendByte(UART_OPERATION_SUCCESS);
 
-	UART_SendFourBytes(FirstPassword);
+	if (SendPassword(&FirstPassword) == FALSE)
+	{
+		return;
+	}
 
 	LCD_clearScreen();
 	LCD_displayStringCenter(0, "DONE");
@@ -519,9 +538,8 @@ void System_init_HMI()
 {
 	LCD_init();
 	PogressBar_init();
-	UART_init(&UART_HMI_Config);
+	LINK_init(LINK_ROLE_HMI);
 
-	UART_RX_SetCallBack(UART_RECEIVE_ISR);
 	Timer1_OCA_SetCallBack(TIMER1_ISR);
 
 	sei(); // enable global interrupts in MC.
@@ -539,7 +557,7 @@ void SystemOptions_HMI()
 
 	if (option == '-' || option == '+')
 	{
-		UART_SendByte(option);
+		LINK_SendByte(option);
 
 		switch (option)
 		{
@@ -563,6 +581,8 @@ void SystemOptions_HMI()
 //========================================== Main ==============================================
 void HMI_MCU(void)
 {
+	uint8 response;
+
 	//=================== System Initialization ==============
 	System_init_HMI();
 
@@ -570,9 +590,15 @@ void HMI_MCU(void)
 	_delay_ms(LCD_WAITING_TIME);
 
 	//=================== Send Ready to Control MCU =========
-	UART_SendByte(UART_HMI_READY);
+	LINK_SendByte(UART_HMI_READY);
+
+	// answer every call of the CONTROL MCU until it tells if it's the first time
+	while ((response = LINK_ReceiveByte()) == UART_CONTROL_READY)
+	{
+		LINK_SendByte(UART_HMI_READY);
+	}
 
-	switch (UART_ReceiveByte())
+	switch (response)
 	{
 	case UART_First_time:
 
@@ -595,7 +621,7 @@ void HMI_MCU(void)
 
 		//============================= Testing ================================
 		// LCD_Goto_XY(1, 0);
-		// UART_SendByte(UART_HMI_READY); // send ready signal to CONTROL
+		// LINK_SendByte(UART_HMI_READY); // send ready signal to CONTROL
 		// UART_ReceiveFourBytes(&pass);
 
 		// LCD_displayInteger(pass);
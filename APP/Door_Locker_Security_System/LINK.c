@@ -0,0 +1,262 @@
+/******************************************************************************
+ * @file   : LINK.c
+ * @brief  : Message link between the HMI and the CONTROL MCUs.
+ *           UART transport: 9600 baud, frames acknowledged by UART_Services (a message byte is a
+ *           one-byte frame, so a lost or corrupted byte is retransmitted instead of desyncing the MCUs).
+ *           SPI transport: the CONTROL MCU is the master and clocks the HMI (slave engine of
+ *           SPI_services) only when it sends or when the HMI data ready line is low, about 130 us
+ *           per byte instead of about 1 ms plus the frame acknowledgements of the UART.
+ * @author : Hossam Mohamed
+ * @Target : ATMEGA32 MCU (AVR)
+ *******************************************************************************/
+
+#include "LINK.h"
+
+#include "SPI.h" // for the SPI clock rates of System_config.h
+#include "System_config.h"
+
+#include "TIMER.h"
+
+#if (LINK_TRANSPORT == LINK_TRANSPORT_UART)
+#include "UART_Services.h"
+#elif (LINK_TRANSPORT == LINK_TRANSPORT_SPI)
+#include "GPIO.h"
+#include "QUEUE.h"
+#include "SPI_config.h" // for the gaps of the slave engine
+#include "SPI_services.h"
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#else
+#error "LINK_TRANSPORT must be LINK_TRANSPORT_UART or LINK_TRANSPORT_SPI"
+#endif
+
+//======================================== Transport: UART ======================================
+#if (LINK_TRANSPORT == LINK_TRANSPORT_UART)
+
+static UART_ConfigType LINK_UART_Config = {UART_8_BIT_DATA, UART_1_STOP_BIT, UART_NO_PARITY, BAUD_9600};
+
+void LINK_init(LINK_RoleType a_role)
+{
+	(void)a_role; // both MCUs are the same on the UART
+
+	UART_init(&LINK_UART_Config);
+	Timer2_Tick_init();
+}
+
+LINK_StatusType LINK_SendByte(uint8 a_data)
+{
+	return (UART_SendFrame(&a_data, 1) == UART_FRAME_OK) ? LINK_OK : LINK_ERROR;
+}
+
+uint8 LINK_ReadByte(uint8 *ptr_data)
+{
+	uint8 length;
+
+	/* shortest wait of the frame receiver (one tick), a frame that has started is received completely */
+	return (UART_ReceiveFrameTimeout(ptr_data, &length, 1, 1) == UART_FRAME_OK && length == 1) ? TRUE : FALSE;
+}
+
+LINK_StatusType LINK_SendFrame(const uint8 *a_data, uint8 a_length)
+{
+	return (UART_SendFrame(a_data, a_length) == UART_FRAME_OK) ? LINK_OK : LINK_ERROR;
+}
+
+LINK_StatusType LINK_ReceiveFrame(uint8 *a_data, uint8 *a_length, uint8 a_maxLength)
+{
+	UART_ReceiveFrame(a_data, a_length, a_maxLength);
+	return LINK_OK;
+}
+
+//======================================== Transport: SPI =======================================
+#elif (LINK_TRANSPORT == LINK_TRANSPORT_SPI)
+
+/* CS of the HMI on the bus of the CONTROL MCU */
+static SPI_DeviceType LINK_HMI_Device = {PORTB_ID, PIN4_ID, SPI_MODE_0, LINK_SPI_CLOCK_RATE, FALSE, SPI_MSB_FIRST, 0, 0};
+
+/* bytes of the HMI received by the CONTROL MCU while it clocks the bus */
+QUEUE_DEFINE(LINK_RxQueue, uint8, LINK_RX_BUFFER_SIZE)
+
+static LINK_RoleType LINK_role = LINK_ROLE_CTRL;
+static boolean LINK_headerReceived = FALSE; // the next byte of the stream is data
+
+/* returns TRUE when a_byte completes a [header][data] pair */
+static boolean LINK_Parse(uint8 a_byte)
+{
+	if (LINK_headerReceived == TRUE)
+	{
+		LINK_headerReceived = FALSE;
+		return TRUE;
+	}
+	if (a_byte == LINK_SPI_HEADER)
+	{
+		LINK_headerReceived = TRUE;
+	}
+	return FALSE; // idle byte
+}
+
+/*
+ * CONTROL: one pair on the bus, the bytes clocked out of the HMI are parsed at the same time.
+ * Not SPI_transferBlock: the HMI needs LINK_SPI_BYTE_GAP_US between the bytes to preload its response.
+ */
+static void LINK_Exchange(uint8 a_header, uint8 a_data)
+{
+	uint8 frame[2];
+	uint8 i;
+
+	SPI_select(&LINK_HMI_Device);
+	frame[0] = SPI_sendReceiveByte(a_header);
+	_delay_us(LINK_SPI_BYTE_GAP_US);
+	frame[1] = SPI_sendReceiveByte(a_data);
+	SPI_deselect(&LINK_HMI_Device);
+	_delay_us(LINK_SPI_FRAME_GAP_US);
+
+	for (i = 0; i < 2; i++)
+	{
+		if (LINK_Parse(frame[i]) == TRUE)
+		{
+			LINK_RxQueue_Push(frame[i]); // dropped if the application doesn't read
+		}
+	}
+}
+
+void LINK_init(LINK_RoleType a_role)
+{
+	LINK_role = a_role;
+	LINK_headerReceived = FALSE;
+
+	if (a_role == LINK_ROLE_CTRL)
+	{
+		SPI_init(SPI_Master, LINK_SPI_CLOCK_RATE);
+		SPI_Device_init(&LINK_HMI_Device);
+
+		/* high (pull up) while the HMI is not driving it yet */
+		GPIO_setupPinDirection(LINK_DRDY_PORT_ID, LINK_DRDY_PIN_ID, PIN_INPUT);
+		GPIO_writePin(LINK_DRDY_PORT_ID, LINK_DRDY_PIN_ID, LOGIC_HIGH);
+	}
+	else
+	{
+		SPI_Slave_init();
+	}
+	Timer2_Tick_init();
+}
+
+LINK_StatusType LINK_SendByte(uint8 a_data)
+{
+	uint8 sreg;
+
+	if (LINK_role == LINK_ROLE_CTRL)
+	{
+		LINK_Exchange(LINK_SPI_HEADER, a_data);
+	}
+	else
+	{
+		while (SPI_Slave_GetTxFree() < 2)
+		{
+			// wait for the CONTROL MCU to clock the queued bytes
+		}
+
+		/* the pair must not be split by an idle byte of the slave interrupt */
+		sreg = SREG;
+		cli();
+		SPI_Slave_WriteByte(LINK_SPI_HEADER);
+		SPI_Slave_WriteByte(a_data);
+		SREG = sreg;
+	}
+	return LINK_OK;
+}
+
+uint8 LINK_ReadByte(uint8 *ptr_data)
+{
+	uint8 data;
+
+	if (LINK_role == LINK_ROLE_CTRL)
+	{
+		/* the HMI has data, or the data byte of a pair is still in its shift register */
+		if (LINK_RxQueue_Count() == 0 &&
+			(LINK_headerReceived == TRUE || GPIO_readPin(LINK_DRDY_PORT_ID, LINK_DRDY_PIN_ID) == LOGIC_LOW))
+		{
+			LINK_Exchange(SPI_DEFAULT_DATA_VALUE, SPI_DEFAULT_DATA_VALUE);
+		}
+		return LINK_RxQueue_Pop(ptr_data);
+	}
+
+	/* HMI: the idle pairs clocked by the CONTROL MCU are skipped */
+	while (SPI_Slave_ReadByte(&data) == TRUE)
+	{
+		if (LINK_Parse(data) == TRUE)
+		{
+			*ptr_data = data;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/* the SPI is not corrupted on a board, so the frame is [length][bytes] without CRC or acknowledgement */
+LINK_StatusType LINK_SendFrame(const uint8 *a_data, uint8 a_length)
+{
+	uint8 i;
+
+	(void)LINK_SendByte(a_length);
+	for (i = 0; i < a_length; i++)
+	{
+		(void)LINK_SendByte(a_data[i]);
+	}
+	return LINK_OK;
+}
+
+LINK_StatusType LINK_ReceiveFrame(uint8 *a_data, uint8 *a_length, uint8 a_maxLength)
+{
+	uint8 length;
+	uint8 data;
+	uint8 i;
+
+	while (1)
+	{
+		length = LINK_ReceiveByte();
+		for (i = 0; i < length; i++)
+		{
+			if (LINK_ReceiveByteTimeout(&data, LINK_FRAME_BYTE_TIMEOUT) == LINK_TIMEOUT)
+			{
+				break; // incomplete frame, wait for the next one
+			}
+			if (i < a_maxLength)
+			{
+				a_data[i] = data;
+			}
+		}
+
+		if (i == length && length <= a_maxLength)
+		{
+			*a_length = length;
+			return LINK_OK;
+		}
+	}
+}
+
+#endif /* LINK_TRANSPORT */
+
+//======================================== Common ===============================================
+uint8 LINK_ReceiveByte(void)
+{
+	uint8 data;
+
+	while (LINK_ReadByte(&data) == FALSE)
+	{
+	}
+	return data;
+}
+
+LINK_StatusType LINK_ReceiveByteTimeout(uint8 *ptr_data, uint16 a_timeout_ms)
+{
+	uint32 start = Timer2_Tick_getMs();
+
+	while (LINK_ReadByte(ptr_data) == FALSE)
+	{
+		if ((uint32)(Timer2_Tick_getMs() - start) >= a_timeout_ms)
+		{
+			return LINK_TIMEOUT;
+		}
+	}
+	return LINK_OK;
+}
@@ -0,0 +1,84 @@
+/******************************************************************************
+ * @file   : LINK.h
+ * @brief  : Message link between the HMI and the CONTROL MCUs, over the UART or the SPI
+ *           (selected by LINK_TRANSPORT in System_config.h).
+ * @author : Hossam Mohamed
+ * @Target : ATMEGA32 MCU (AVR)
+ *******************************************************************************/
+#ifndef LINK_H
+#define LINK_H
+
+#include "STD_TYPES.h"
+
+/*******************************************************************************
+ *                      User Defined Types                                     *
+ *******************************************************************************/
+typedef enum
+{
+	LINK_ROLE_CTRL, // SPI master
+	LINK_ROLE_HMI	// SPI slave
+} LINK_RoleType;
+
+typedef enum
+{
+	LINK_OK,
+	LINK_TIMEOUT,
+	LINK_ERROR // the frame was not acknowledged (UART transport)
+} LINK_StatusType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description : Initialize the transport of this MCU and the Timer2 system tick used by the timeouts.
+ * arguments   : LINK_RoleType a_role : LINK_ROLE_CTRL or LINK_ROLE_HMI
+ * Return      : None
+ * Note        : the global interrupts must be enabled
+ */
+void LINK_init(LINK_RoleType a_role);
+
+/*
+ * Description : Send one message byte to the other MCU.
+ * Return      : LINK_StatusType : [LINK_OK, LINK_ERROR (not acknowledged, UART transport only)]
+ * Note        : UART transport: the byte is a frame, blocking until the other MCU acknowledges it
+ */
+LINK_StatusType LINK_SendByte(uint8 a_data);
+
+/*
+ * Description : Get the next message byte of the other MCU if there is one.
+ * arguments   : uint8 *ptr_data : pointer to the variable to store the received byte
+ * Return      : uint8 : status of the function [TRUE, FALSE (nothing received)]
+ * Note        : this function is non-blocking function
+ */
+uint8 LINK_ReadByte(uint8 *ptr_data);
+
+/*
+ * Description : Wait for the next message byte of the other MCU.
+ * Note        : this function is blocking function
+ */
+uint8 LINK_ReceiveByte(void);
+
+/*
+ * Description : Wait for the next message byte of the other MCU at most a_timeout_ms.
+ * Return      : LINK_StatusType : [LINK_OK, LINK_TIMEOUT (*ptr_data is not changed)]
+ */
+LINK_StatusType LINK_ReceiveByteTimeout(uint8 *ptr_data, uint16 a_timeout_ms);
+
+/*
+ * Description : Send a block of bytes (password).
+ * Return      : LINK_StatusType : [LINK_OK, LINK_ERROR (not acknowledged, UART transport only)]
+ */
+LINK_StatusType LINK_SendFrame(const uint8 *a_data, uint8 a_length);
+
+/*
+ * Description : Wait for the next complete block of bytes.
+ * arguments   : uint8 *a_data : buffer for the bytes
+ * 				 uint8 *a_length : pointer to the variable to store the number of received bytes
+ * 				 uint8 a_maxLength : size of the buffer, longer blocks are dropped
+ * Return      : LINK_StatusType : LINK_OK
+ * Note        : this function is blocking function until a valid block is received
+ */
+LINK_StatusType LINK_ReceiveFrame(uint8 *a_data, uint8 *a_length, uint8 a_maxLength);
+
+#endif /* LINK_H */
@@ -19,6 +19,41 @@
 #define KEYPAD_PRESS_TIME 					(350)
 #define LCD_WAITING_TIME 					(800)
 
+#define UART_HANDSHAKE_TIMEOUT 				(500)	/* ms to wait for the other MCU before retrying */
+#define UART_RESPONSE_TIMEOUT 				(2000)	/* ms to wait for the HMI during a door operation */
+#define LINK_FRAME_SEND_ATTEMPTS 			(3)		/* LINK_SendFrame calls before the HMI reports a link error */
+
+/***************************************************************
+ * 					Link Configuration 	 					   *
+ ***************************************************************/
+#define LINK_TRANSPORT_UART 				0	/* 9600 baud UART, CRC protected frames */
+#define LINK_TRANSPORT_SPI 					1	/* CTRL is the SPI master, HMI the slave */
+
+#ifndef LINK_TRANSPORT 	/* make LINK=SPI selects the SPI transport and moves the keypad, see bin/Makefile */
+#define LINK_TRANSPORT 						LINK_TRANSPORT_UART
+#endif
+
+/*
+ * SPI transport wiring (both MCUs):
+ * 		HMI PB4..PB7 (SS, MOSI, MISO, SCK) <-> CTRL PB4..PB7, CTRL PB4 is the chip select of the HMI
+ * 		HMI PB2 (INT2) tied to HMI PB4, the slave engine delimits the frames on the SS edges
+ * 		HMI PA3 (SPI_SLAVE_DRDY pin) -> CTRL LINK_DRDY pin, low while the HMI has bytes to send
+ * 		HMI keypad on PORTD instead of PORTB (rows PD0..PD3, columns PD4..PD7), the UART pins are unused.
+ * Every byte is sent as a [LINK_SPI_HEADER][data] pair, the CTRL clocks idle pairs to read the HMI.
+ */
+#define LINK_SPI_HEADER 					0xA5
+#define LINK_SPI_CLOCK_RATE 				SPI_FOSC_64
+/*
+ * The bytes of a pair are sent one by one: the HMI interrupt preloads its response between two bytes
+ * (the byte time doesn't give it any time), see SPI_SLAVE_BYTE_GAP_CYCLES. Both MCUs run at F_CPU.
+ */
+#define LINK_SPI_BYTE_GAP_US 				(SPI_SLAVE_BYTE_GAP_CYCLES * 1000000UL / F_CPU + 1)
+#define LINK_SPI_FRAME_GAP_US 				(SPI_SLAVE_SS_GAP_CYCLES * 1000000UL / F_CPU + 1)	/* CS high time */
+#define LINK_DRDY_PORT_ID 					PORTA_ID
+#define LINK_DRDY_PIN_ID 					PIN3_ID
+#define LINK_RX_BUFFER_SIZE 				16			/* CTRL side, power of two */
+#define LINK_FRAME_BYTE_TIMEOUT 			100			/* ms between the bytes of a frame */
+
 /***************************************************************
  * 					UART Messages Definitions 				   *
  ***************************************************************/
@@ -9,12 +9,38 @@
 
 #include "Ultrasonic_sensor_APP.h"
 #include <avr/interrupt.h>
+
+#if (ULTRASONIC_I2C_SLAVE == TRUE)
+#include "TWI.h"
+#include "TWI_services.h"
+
+#define ULTRASONIC_REG_DISTANCE 	0x00
+#define ULTRASONIC_REG_COUNTER 		0x02
+#define ULTRASONIC_REG_PERIOD 		0x03
+#define ULTRASONIC_REG_COUNT 		4
+
+static volatile uint8 Ultrasonic_Registers[ULTRASONIC_REG_COUNT];
+static const TWI_Slave_RegisterMapType Ultrasonic_RegisterMap = {Ultrasonic_Registers, ULTRASONIC_REG_COUNT,
+																 ULTRASONIC_REG_PERIOD, NULL_PTR};
+static TWI_configType Ultrasonic_TWI_Config = {NormalMode_100Kb, TWI_Prescaler_1,
+											   TWI_GeneralCallRecognitionEnable_OFF, ULTRASONIC_I2C_SLAVE_ADDRESS};
+#endif
+
 void Ultrasonic_sensor(void)
 {
 	uint16 distance = 0;
+#if (ULTRASONIC_I2C_SLAVE == TRUE)
+	uint8 measurement[3];
+	uint8 counter = 0;
+	uint8 period;
+#endif
 	/* INITIALIZATION */
 	Ultrasonic_init();
 	LCD_init();
+#if (ULTRASONIC_I2C_SLAVE == TRUE)
+	TWI_init(&Ultrasonic_TWI_Config);
+	TWI_Slave_init(ULTRASONIC_I2C_SLAVE_ADDRESS, &Ultrasonic_RegisterMap);
+#endif
 
 	LCD_displayString("Distance = ");
 
@@ -32,5 +58,20 @@ void Ultrasonic_sensor(void)
 		LCD_Goto_XY(0, 10);
 		LCD_displayInteger(distance);
 		LCD_displayString(" cm");
+
+#if (ULTRASONIC_I2C_SLAVE == TRUE)
+		/* publish the distance and the counter together, retried while the master is reading */
+		measurement[0] = (uint8)(distance >> 8);
+		measurement[1] = (uint8)distance;
+		measurement[2] = ++counter;
+		while (TWI_Slave_WriteRegisters(ULTRASONIC_REG_DISTANCE, measurement, 3) == FALSE)
+		{
+		}
+
+		for (period = Ultrasonic_Registers[ULTRASONIC_REG_PERIOD]; period != 0; period--)
+		{
+			_delay_ms(10);
+		}
+#endif
 	}
 }
\ No newline at end of file
@@ -15,6 +15,22 @@
 #include <util/delay.h>
 
 #include "ICU.h"
+#include "LCD_config.h"
+
+/******************* Register map served over I2C *********************************/
+/*
+ * TRUE: an external master reads the measurements from the TWI slave register map:
+ * 	0x00-0x01	distance in cm (MSB first)		read-only
+ * 	0x02		measurement counter				read-only
+ * 	0x03		measurement period (x10 ms)		read-write
+ * The TWI pins are PC0/PC1, so the LCD must use the 4-bit mode (DB4..DB7 on PC3..PC6).
+ */
+#define ULTRASONIC_I2C_SLAVE 			FALSE
+#define ULTRASONIC_I2C_SLAVE_ADDRESS 	0x30
+
+#if (ULTRASONIC_I2C_SLAVE == TRUE) && (LCD_DATA_BITS_MODE == _8_BIT_MODE)
+#error "ULTRASONIC_I2C_SLAVE needs the LCD in 4-bit mode, PC0/PC1 are the TWI pins"
+#endif
 
 
 void Ultrasonic_sensor(void);
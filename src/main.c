@@ -4,9 +4,13 @@
 
 #include "Stopwatch.h"
 
+// #include "Benchmarks.h"
+
 int main(void)
 {
 	// CTRL_MCU();
 
+	// Benchmarks_main();
+
 	Stopwatch_main();
 }
\ No newline at end of file